@@ -89,6 +89,10 @@ class Application {
     std::unique_ptr<Viewfinder> viewfinder;
     std::shared_ptr<Dispatcher> dispatcher;
     std::unique_ptr<RayBank> ray_bank;
+    std::unique_ptr<EndpointGraph> endpoint_graph;
+    std::unique_ptr<MeasurementCache> measurements;
+    std::unique_ptr<IntersectionIndex> intersections;
+    std::unique_ptr<SnapIndex> snap_index;
     FrametimeCounter frametime_counter;
     Container root;
     Container root2;
@@ -101,7 +105,8 @@ class Application {
     void Update(Controller& controller);
 
     Cad::Controller CreateController(Core::Controller& controller) {
-        return Cad::Controller(controller, *registry, *viewfinder, *ray_bank);
+        return Cad::Controller(controller, *registry, *viewfinder, *ray_bank, *endpoint_graph, *measurements,
+            *intersections, *snap_index);
     }
 
     std::shared_ptr<Dispatcher>& GetDispatcher() { return dispatcher; }
@@ -4,6 +4,8 @@
 #include <cad/syntax/Syntax.h>
 #include <cad/object/ObjectBuilder.h>
 
+#include <optional>
+
 namespace Cad {
 
 struct Command {
@@ -178,5 +180,497 @@ struct CreateCircle : public Cad::Command {
     };
 };
 
+// Switch to a layer, creating it if it doesn't exist yet, or change one of its attributes. The attribute is one of
+// "show", "hide", "lock", "unlock" or a color name.
+struct LayerCommand : public Cad::Command {
+    std::string name;
+    std::string attribute;
+
+    LayerCommand(std::string name, std::string attribute = "") : name(name), attribute(attribute) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("layer", {Cad::Syntax::Arg::Type::STRING}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<LayerCommand>(args[0].AsString());
+        }
+    };
+
+    struct AttributeSignature : Cad::Syntax::ArgSignature {
+        AttributeSignature()
+            : ArgSignature("layer", {Cad::Syntax::Arg::Type::STRING, Cad::Syntax::Arg::Type::STRING}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<LayerCommand>(args[0].AsString(), args[1].AsString());
+        }
+    };
+};
+
+// List every layer with its object count and state, the current layer is marked with a '*'
+struct LayersCommand : public Cad::Command {
+    LayersCommand() = default;
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("layers", {}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<LayersCommand>();
+        }
+    };
+};
+
+// Turn the selection into a block with its base point at the cursor, and replace the selection with an insert of it
+struct BlockCommand : public Cad::Command {
+    std::string name;
+
+    BlockCommand(std::string name) : name(name) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("block", {Cad::Syntax::Arg::Type::STRING}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<BlockCommand>(args[0].AsString());
+        }
+    };
+};
+
+// Place a block at a point, optionally scaled and rotated (in degrees) about its base point
+struct InsertCommand : public Cad::Command {
+    std::string name;
+    Core::Vector2 position;
+    float scale;
+    float rotation;
+
+    InsertCommand(std::string name, Core::Vector2 position, float scale = 1, float rotation = 0)
+        : name(name), position(position), scale(scale), rotation(rotation) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("insert", {Cad::Syntax::Arg::Type::STRING, Cad::Syntax::Arg::Type::VECTOR2}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<InsertCommand>(args[0].AsString(), args[1].AsVector2());
+        }
+    };
+
+    struct TransformSignature : Cad::Syntax::ArgSignature {
+        TransformSignature()
+            : ArgSignature("insert", {Cad::Syntax::Arg::Type::STRING, Cad::Syntax::Arg::Type::VECTOR2,
+                                         Cad::Syntax::Arg::Type::FLOAT, Cad::Syntax::Arg::Type::FLOAT}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<InsertCommand>(
+                args[0].AsString(), args[1].AsVector2(), args[2].AsFloat(), args[3].AsFloat());
+        }
+    };
+};
+
+// Move the selection by an offset, rotate it (in degrees) or scale it about a base point, or mirror it across the line
+// through two points
+struct TransformCommand : public Cad::Command {
+    Core::Matrix3 matrix;
+
+    TransformCommand(Core::Matrix3 matrix) : matrix(matrix) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct MoveSignature : Cad::Syntax::ArgSignature {
+        MoveSignature() : ArgSignature("move", {Cad::Syntax::Arg::Type::VECTOR2}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            Core::Vector2 offset = args[0].AsVector2();
+            return std::make_unique<TransformCommand>(Core::Matrix3::Translation(offset.x, offset.y));
+        }
+    };
+
+    struct RotateSignature : Cad::Syntax::ArgSignature {
+        RotateSignature() : ArgSignature("rotate", {Cad::Syntax::Arg::Type::VECTOR2, Cad::Syntax::Arg::Type::FLOAT}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            float angle = args[1].AsFloat() * M_PI / 180;
+            return std::make_unique<TransformCommand>(Core::Matrix3::Rotation(args[0].AsVector2(), angle));
+        }
+    };
+
+    struct ScaleSignature : Cad::Syntax::ArgSignature {
+        ScaleSignature() : ArgSignature("scale", {Cad::Syntax::Arg::Type::VECTOR2, Cad::Syntax::Arg::Type::FLOAT}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<TransformCommand>(Core::Matrix3::Scale(args[0].AsVector2(), args[1].AsFloat()));
+        }
+    };
+
+    struct MirrorSignature : Cad::Syntax::ArgSignature {
+        MirrorSignature()
+            : ArgSignature("mirror", {Cad::Syntax::Arg::Type::VECTOR2, Cad::Syntax::Arg::Type::VECTOR2}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            Core::Vector2 a = args[0].AsVector2();
+            Core::Vector2 b = args[1].AsVector2();
+            return std::make_unique<TransformCommand>(Core::Matrix3::Reflection(a, b - a));
+        }
+    };
+};
+
+// Repeat the selection in a grid of rows and columns spaced by an offset, or a number of times around a center over
+// an angle in degrees (360 for a full turn). With "block" the copies are inserts of one block made from the
+// selection, otherwise they are copies of its objects. The selection itself is the first item either way.
+struct ArrayCommand : public Cad::Command {
+    // Where each copy goes, the selection itself is left out
+    std::vector<Core::Matrix3> placements;
+    bool instanced;
+
+    ArrayCommand(std::vector<Core::Matrix3> placements, bool instanced)
+        : placements(std::move(placements)), instanced(instanced) {}
+
+    static std::vector<Core::Matrix3> Rectangular(int rows, int columns, Core::Vector2 spacing);
+    static std::vector<Core::Matrix3> Polar(int count, float angle, Core::Vector2 center);
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature()
+            : ArgSignature("array", {Cad::Syntax::Arg::Type::FLOAT, Cad::Syntax::Arg::Type::FLOAT,
+                                        Cad::Syntax::Arg::Type::VECTOR2}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<ArrayCommand>(
+                Rectangular(args[0].AsFloat(), args[1].AsFloat(), args[2].AsVector2()), false);
+        }
+    };
+
+    struct InstancedSignature : Cad::Syntax::ArgSignature {
+        InstancedSignature()
+            : ArgSignature("array", {Cad::Syntax::Arg::Type::FLOAT, Cad::Syntax::Arg::Type::FLOAT,
+                                        Cad::Syntax::Arg::Type::VECTOR2, Cad::Syntax::Arg::Type::STRING}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<ArrayCommand>(Rectangular(args[0].AsFloat(), args[1].AsFloat(),
+                                                      args[2].AsVector2()),
+                args[3].AsString() == "block");
+        }
+    };
+
+    struct PolarSignature : Cad::Syntax::ArgSignature {
+        PolarSignature()
+            : ArgSignature("polar", {Cad::Syntax::Arg::Type::FLOAT, Cad::Syntax::Arg::Type::FLOAT,
+                                        Cad::Syntax::Arg::Type::VECTOR2}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<ArrayCommand>(
+                Polar(args[0].AsFloat(), args[1].AsFloat(), args[2].AsVector2()), false);
+        }
+    };
+
+    struct InstancedPolarSignature : Cad::Syntax::ArgSignature {
+        InstancedPolarSignature()
+            : ArgSignature("polar", {Cad::Syntax::Arg::Type::FLOAT, Cad::Syntax::Arg::Type::FLOAT,
+                                        Cad::Syntax::Arg::Type::VECTOR2, Cad::Syntax::Arg::Type::STRING}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<ArrayCommand>(
+                Polar(args[0].AsFloat(), args[1].AsFloat(), args[2].AsVector2()), args[3].AsString() == "block");
+        }
+    };
+};
+
+// Trim the object at the point back to the nearest objects crossing it on either side, or with two points trim every
+// object the fence between them crosses where it crosses it
+struct TrimCommand : public Cad::Command {
+    Core::Vector2 a;
+    std::optional<Core::Vector2> b;
+
+    TrimCommand(Core::Vector2 a, std::optional<Core::Vector2> b) : a(a), b(b) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("trim", {Cad::Syntax::Arg::Type::VECTOR2}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<TrimCommand>(args[0].AsVector2(), std::nullopt);
+        }
+    };
+
+    struct FenceSignature : Cad::Syntax::ArgSignature {
+        FenceSignature() : ArgSignature("trim", {Cad::Syntax::Arg::Type::VECTOR2, Cad::Syntax::Arg::Type::VECTOR2}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<TrimCommand>(args[0].AsVector2(), args[1].AsVector2());
+        }
+    };
+};
+
+// Extend the selected lines and open polylines at both ends to the nearest object ahead, or only the end of the
+// object at the point that is closer to it
+struct ExtendCommand : public Cad::Command {
+    std::optional<Core::Vector2> point;
+
+    ExtendCommand(std::optional<Core::Vector2> point) : point(point) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("extend", {}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<ExtendCommand>(std::nullopt);
+        }
+    };
+
+    struct PointSignature : Cad::Syntax::ArgSignature {
+        PointSignature() : ArgSignature("extend", {Cad::Syntax::Arg::Type::VECTOR2}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<ExtendCommand>(args[0].AsVector2());
+        }
+    };
+};
+
+// Copy the selected lines, polylines and circles parallel to themselves at a distance, negative for the other side
+struct OffsetCommand : public Cad::Command {
+    float distance;
+
+    OffsetCommand(float distance) : distance(distance) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("offset", {Cad::Syntax::Arg::Type::FLOAT}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<OffsetCommand>(args[0].AsFloat());
+        }
+    };
+};
+
+// Take back the latest changes to the drawing, or make the ones taken back again, a number of steps at a time
+struct UndoCommand : public Cad::Command {
+    bool redo;
+    int steps;
+
+    UndoCommand(bool redo, int steps) : redo(redo), steps(steps) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("undo", {}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<UndoCommand>(false, 1);
+        }
+    };
+
+    struct StepsSignature : Cad::Syntax::ArgSignature {
+        StepsSignature() : ArgSignature("undo", {Cad::Syntax::Arg::Type::FLOAT}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<UndoCommand>(false, args[0].AsFloat());
+        }
+    };
+
+    struct RedoSignature : Cad::Syntax::ArgSignature {
+        RedoSignature() : ArgSignature("redo", {}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<UndoCommand>(true, 1);
+        }
+    };
+
+    struct RedoStepsSignature : Cad::Syntax::ArgSignature {
+        RedoStepsSignature() : ArgSignature("redo", {Cad::Syntax::Arg::Type::FLOAT}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<UndoCommand>(true, args[0].AsFloat());
+        }
+    };
+};
+
+// Set how much memory the undo history may hold, in megabytes, and report how much it holds now
+struct UndoBudgetCommand : public Cad::Command {
+    float megabytes;
+
+    UndoBudgetCommand(float megabytes) : megabytes(megabytes) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("undobudget", {Cad::Syntax::Arg::Type::FLOAT}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<UndoBudgetCommand>(args[0].AsFloat());
+        }
+    };
+};
+
+// Extend the selection along the chains of connected lines and polylines running through the selected objects
+struct ChainCommand : public Cad::Command {
+    ChainCommand() = default;
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("chain", {}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<ChainCommand>();
+        }
+    };
+};
+
+// Replace the chain through each selected object with a single polyline
+struct JoinCommand : public Cad::Command {
+    JoinCommand() = default;
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("join", {}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<JoinCommand>();
+        }
+    };
+};
+
+// Select every line and polyline with an end that doesn't meet anything, and report how many such ends there are
+struct OpenEndsCommand : public Cad::Command {
+    OpenEndsCommand() = default;
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("openends", {}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<OpenEndsCommand>();
+        }
+    };
+};
+
+// Hatch the region enclosed by the selected circles, closed polylines and closed chains of lines and polylines, solid
+// or with lines a distance apart at an angle in degrees. Loops inside loops are holes, or with "nonzero" only where
+// they run the other way.
+struct HatchCommand : public Cad::Command {
+    float spacing;
+    float angle;
+    Core::FillRule rule;
+
+    HatchCommand(float spacing, float angle, Core::FillRule rule) : spacing(spacing), angle(angle), rule(rule) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("hatch", {}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<HatchCommand>(0, 0, Core::FillRule::EvenOdd);
+        }
+    };
+
+    struct PatternSignature : Cad::Syntax::ArgSignature {
+        PatternSignature() : ArgSignature("hatch", {Cad::Syntax::Arg::Type::FLOAT, Cad::Syntax::Arg::Type::FLOAT}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<HatchCommand>(args[0].AsFloat(), args[1].AsFloat(), Core::FillRule::EvenOdd);
+        }
+    };
+
+    struct RuleSignature : Cad::Syntax::ArgSignature {
+        RuleSignature()
+            : ArgSignature("hatch", {Cad::Syntax::Arg::Type::FLOAT, Cad::Syntax::Arg::Type::FLOAT,
+                                        Cad::Syntax::Arg::Type::STRING}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            auto rule = args[2].AsString() == "nonzero" ? Core::FillRule::NonZero : Core::FillRule::EvenOdd;
+            return std::make_unique<HatchCommand>(args[0].AsFloat(), args[1].AsFloat(), rule);
+        }
+    };
+};
+
+// Find duplicate and overlapped objects on editable layers and select them, or with "delete" remove them all at once
+struct DedupeCommand : public Cad::Command {
+    bool remove;
+
+    DedupeCommand(bool remove) : remove(remove) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("dedupe", {}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<DedupeCommand>(false);
+        }
+    };
+
+    struct DeleteSignature : Cad::Syntax::ArgSignature {
+        DeleteSignature() : ArgSignature("dedupe", {Cad::Syntax::Arg::Type::STRING}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<DedupeCommand>(args[0].AsString() == "delete");
+        }
+    };
+};
+
+// Report count, counts by type, total length, enclosed area and extents of the selection, or of the whole drawing if
+// nothing is selected or "all" is given
+struct MeasureCommand : public Cad::Command {
+    bool all;
+
+    MeasureCommand(bool all) : all(all) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("measure", {}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<MeasureCommand>(false);
+        }
+    };
+
+    struct AllSignature : Cad::Syntax::ArgSignature {
+        AllSignature() : ArgSignature("measure", {Cad::Syntax::Arg::Type::STRING}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<MeasureCommand>(args[0].AsString() == "all");
+        }
+    };
+};
+
+// Times the same read-only pass (the total length of the drawing) through the virtual ObjectVisitor, the tag
+// dispatched ObjectRegistry::Visit and std::visit over a packed ObjectVariant copy, and reports each in milliseconds
+struct BenchCommand : public Cad::Command {
+    int iterations;
+
+    BenchCommand(int iterations) : iterations(iterations) {}
+
+    void Forward(Cad::Controller& cad) override;
+
+    struct Signature : Cad::Syntax::ArgSignature {
+        Signature() : ArgSignature("bench", {}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            return std::make_unique<BenchCommand>(10);
+        }
+    };
+
+    struct IterationsSignature : Cad::Syntax::ArgSignature {
+        IterationsSignature() : ArgSignature("bench", {Cad::Syntax::Arg::Type::FLOAT}) {}
+
+        std::unique_ptr<Cad::Command> Create(std::vector<Cad::Syntax::Arg> args) override {
+            int iterations = args[0].AsFloat();
+            return std::make_unique<BenchCommand>(iterations < 1 ? 1 : iterations);
+        }
+    };
+};
 
-} // namespace Cad
\ No newline at end of file
+} // namespace Cad
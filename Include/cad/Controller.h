@@ -1,7 +1,11 @@
 #pragma once
 
 #include <core/Controller.h>
+#include <cad/object/EndpointGraph.h>
+#include <cad/object/IntersectionIndex.h>
+#include <cad/object/Measure.h>
 #include <cad/object/ObjectRegistry.h>
+#include <cad/object/SnapIndex.h>
 #include <cad/Viewfinder.h>
 
 namespace Cad {
@@ -11,9 +15,17 @@ struct Controller : public Core::Controller {
     ObjectRegistry& registry;
     Viewfinder& viewfinder;
     RayBank& ray_bank;
+    EndpointGraph& endpoint_graph;
+    MeasurementCache& measurements;
+    IntersectionIndex& intersections;
+    SnapIndex& snap_index;
 
-    Controller(Core::Controller& controller, ObjectRegistry& registry, Viewfinder& viewfinder, RayBank& ray_bank) : 
-        controller(controller), registry(registry), viewfinder(viewfinder), ray_bank(ray_bank) {}
+    Controller(Core::Controller& controller, ObjectRegistry& registry, Viewfinder& viewfinder, RayBank& ray_bank,
+        EndpointGraph& endpoint_graph, MeasurementCache& measurements, IntersectionIndex& intersections,
+        SnapIndex& snap_index)
+        : controller(controller), registry(registry), viewfinder(viewfinder), ray_bank(ray_bank),
+          endpoint_graph(endpoint_graph), measurements(measurements), intersections(intersections),
+          snap_index(snap_index) {}
 
     Core::Graphics& GetGraphics() override {
         return controller.GetGraphics();
@@ -48,5 +60,25 @@ struct Controller : public Core::Controller {
     virtual Cad::Viewfinder& GetViewfinder() {
         return viewfinder;
     }
+
+    // The derived indexes below are synced with the registry's change journal before they are handed out
+    virtual Cad::EndpointGraph& GetEndpointGraph() {
+        endpoint_graph.Sync(registry);
+        return endpoint_graph;
+    }
+
+    virtual Cad::IntersectionIndex& GetIntersections() {
+        intersections.Sync(registry);
+        return intersections;
+    }
+
+    virtual Cad::SnapIndex& GetSnapIndex() {
+        snap_index.Sync(registry);
+        return snap_index;
+    }
+
+    virtual Cad::MeasurementCache& GetMeasurements() {
+        return measurements;
+    }
 };
 }
\ No newline at end of file
@@ -2,11 +2,15 @@
 
 #include <cad/Ray.h>
 #include <cad/Reticle.h>
+#include <cad/object/IntersectionIndex.h>
 #include <cad/object/Object.h>
 #include <cad/object/ObjectRegistry.h>
+#include <cad/object/SnapIndex.h>
 #include <cad/object/ObjectVisitor.h>
 #include <core/Core.h>
 
+#include <optional>
+
 namespace Cad {
 struct SnapVector {
     Core::Vector2 screen_point;
@@ -14,22 +18,52 @@ struct SnapVector {
 
     SnapVector(Core::Vector2 screen_point, ReticleType type) : screen_point(screen_point), type(type) {}
 };
+// Snap point in world space, so that it stays valid while the mouse moves
+struct SnapCandidate {
+    Core::Vector2 world_point;
+    ReticleType type;
+};
+
+// Everything a snap depends on. The mouse position is kept both as it is and as snapped to the grid, which covers
+// the grid settings.
+struct SnapInputs {
+    Core::Vector2 mouse;
+    Core::Vector2 query;
+    Core::Transform view_transform;
+    uint64_t revision = 0;
+    uint64_t ray_revision = 0;
+
+    bool SameScene(const Core::Transform& view_transform, uint64_t revision, uint64_t ray_revision) const {
+        return this->view_transform == view_transform && this->revision == revision
+               && this->ray_revision == ray_revision;
+    }
+};
+
 class Cursor {
     float x, y;
     float scale;
     std::unique_ptr<Reticle> reticle;
     bool is_grid_snapped = false;
 
+    // The last snap is reused for as long as its inputs are unchanged, so idle frames do no snap work
+    std::optional<SnapInputs> last_inputs;
+    SnapVector last_snap = SnapVector(Core::Vector2(0, 0), ReticleType::None);
+
+    // Candidates within CANDIDATE_RADIUS pixels of the query point they were gathered around. While the scene is the
+    // same and the mouse has moved less than the difference to the snap radius, they hold every snap in reach.
+    std::vector<SnapCandidate> candidates;
+    std::optional<SnapInputs> candidate_inputs;
+
     void update_mouse_location(Core::Controller& controller);
     void snap_cursor_to_grid(Core::Controller& controller, Core::Transform view_transform, float grid_size);
-    void collect_snap_vectors(std::vector<SnapVector>& snap_vectors, ObjectRegistry& registry,
-        Core::Transform view_transform, float grid_size);
-    SnapVector get_closest_snap_vector(std::vector<SnapVector>& snap_vectors, Core::Vector2 mouse_position);
+    void collect_snap_candidates(const ObjectRegistry& registry, const SnapIndex& snaps,
+        const IntersectionIndex& intersections, RayBank& ray_bank, const SnapInputs& inputs);
+    SnapVector get_closest_snap_vector(const SnapInputs& inputs);
 
   public:
     Cursor() = default;
     void Update(Core::Controller& controller, ObjectRegistry& registry, Core::Transform view_transform, float grid_size,
-        RayBank& ray_bank);
+        RayBank& ray_bank, const SnapIndex& snaps, const IntersectionIndex& intersections);
     
 
     Core::Vector2 GetWorldPosition() const { return Core::Vector2(x, y); }
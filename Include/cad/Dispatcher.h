@@ -9,7 +9,8 @@
 
 namespace Cad {
 struct Dispatcher {
-    std::queue<std::unique_ptr<Command>> command_queue;
+    // Commands waiting to run, with the keyword they were entered with
+    std::queue<std::pair<std::string, std::unique_ptr<Command>>> command_queue;
     using SignatureList = std::vector<std::unique_ptr<Syntax::ArgSignature>>;
     std::unordered_map<std::string, SignatureList> commands_map;
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <core/Core.h>
+#include <cad/object/IntersectionIndex.h>
 #include <cad/object/ObjectRegistry.h>
+#include <core/math/Geometry.h>
 #include <optional>
 
 namespace Cad {
@@ -29,7 +31,10 @@ struct Ray {
             : intersection(Intersection::Intersecting), point(point){};
     };
 
-    IntersectionResult GetLineIntersection(Core::Vector2 start, Core::Vector2 end);
+    // Where the line of the ray meets the segment or circle
+    IntersectionResult GetLineIntersection(Core::Vector2 start, Core::Vector2 end) const;
+    Core::Intersections GetCircleIntersections(Core::Vector2 center, float radius) const;
+    Core::Intersections GetRayIntersection(const Ray& other) const;
     void Draw(Core::Graphics& graphics, Core::Transform view_transform);
     bool operator==(const Ray& other) const
     {
@@ -37,27 +42,71 @@ struct Ray {
     }
 };
 
-struct RayBank {
-    std::vector<Ray> rays;
+using RayId = uint32_t;
 
+// Guide rays, kept until they are removed. Rays are whole lines (they are drawn and intersected in both directions)
+// and are looked up by the ID they were given when added. Where they cross each other is worked out when a ray is
+// added; where they cross the drawing is worked out the first time a ray is asked about, with a segment query over
+// the registry's spatial index, and then kept up to date from the registry's journal.
+class RayBank {
+  public:
+    // A ray crossing an object, at origin + t * direction
+    struct Crossing {
+        double t;
+        Core::Vector2 point;
+        ObjectId id;
+    };
+
+  private:
+    struct Entry {
+        RayId id;
+        Ray ray;
+        // Ordered by t, only meaningful while crossed is set
+        std::vector<Crossing> crossings;
+        bool crossed = false;
+    };
+
+    struct RayCrossing {
+        RayId a, b;
+        Core::Vector2 point;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<RayCrossing> ray_crossings;
+    RayId next_id = 1;
+    uint64_t revision = 0;
+
+    ObjectRegistry::Journal::Cursor cursor = 0;
+    bool synced = false;
+    std::vector<IntersectionIndex::Primitive> scratch;
+
+    void Cross(Entry& entry, const Object& object);
+    void Sync(const ObjectRegistry& registry);
+    void Fill(Entry& entry, const ObjectRegistry& registry);
+
+  public:
     RayBank() = default;
 
-    void AddRay(Core::Vector2 origin, Core::Vector2 direction, Core::Pixel color = Core::Color::WHITE)
-    {
-        rays.emplace_back(origin, direction, color);
+    RayId AddRay(Core::Vector2 origin, Core::Vector2 direction, Core::Pixel color = Core::Color::WHITE) {
+        return AddRay(Ray(origin, direction, color));
     }
-    void AddRay(Ray ray) { rays.push_back(ray); }
-    void Draw(Core::Graphics& graphics, Core::Transform view_transform)
-    {
-        for (auto& ray : rays) {
-            ray.Draw(graphics, view_transform);
+    RayId AddRay(Ray ray);
+    bool RemoveRay(RayId id);
+    const Ray* FindRay(RayId id) const;
+    void Clear();
+
+    void Draw(Core::Graphics& graphics, Core::Transform view_transform) {
+        for (auto& entry : entries) {
+            entry.ray.Draw(graphics, view_transform);
         }
     }
 
-    void Clear() { rays.clear(); }
+    // Changes whenever a ray is added or removed
+    uint64_t GetRevision() const { return revision; }
+    size_t Count() const { return entries.size(); }
 
-    std::vector<Core::Vector2> GetSnapPoints(
-        Cad::ObjectRegistry& registry, Core::Transform view_transform, Core::Vector2 mouse_position);
+    // Points inside the rect where the rays cross each other or visible objects
+    std::vector<Core::Vector2> GetSnapPoints(const Cad::ObjectRegistry& registry, const Core::Bounds& rect);
 };
 
 } // namespace Cad
\ No newline at end of file
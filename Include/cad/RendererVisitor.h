@@ -1,28 +1,86 @@
 #pragma once
 
+#include <cad/object/Block.h>
+#include <cad/object/ObjectRegistry.h>
 #include <cad/object/ObjectVisitor.h>
 #include <core/Core.h>
 
+#include <optional>
+
 namespace Cad {
-struct RendererVisitor : public ObjectVisitor {
+struct RendererVisitor : public ConstObjectVisitor {
     Core::Graphics& graphics;
-    RendererVisitor(Core::Graphics& graphics) : graphics(graphics) {}
+    const ObjectRegistry& registry;
+    // Insert being drawn, if any, the block's objects take their color from it
+    const InsertObject* instance = nullptr;
+    // Color to draw everything in instead, for hover highlights
+    std::optional<Core::Pixel> highlight;
+    RendererVisitor(Core::Graphics& graphics, const ObjectRegistry& registry)
+        : graphics(graphics), registry(registry) {}
+
+    // Selected objects are highlighted, the rest are drawn in their layer's color
+    Core::Pixel ColorOf(const Object& object) const {
+        if (highlight) return *highlight;
+        const Object& owner = instance != nullptr ? *instance : object;
+        return registry.IsSelected(owner.GetId()) ? Core::Color::RED : registry.GetLayer(owner.GetLayer()).color;
+    }
 
-    void Visit(LineObject& object) override {
+    void Visit(const LineObject& object) override {
         auto start = object.start;
         auto end = object.end;
-        auto color = object.IsSelected() ? Core::Color::RED : Core::Color::WHITE;
+        auto color = ColorOf(object);
         graphics.DrawLine(color, start.x, start.y, end.x, end.y);
     }
 
-    void Visit(CircleObject& object) override {
+    void Visit(const CircleObject& object) override {
         auto& center = object.center;
         auto radius = object.radius;
-        auto color = object.IsSelected() ? Core::Color::RED : Core::Color::WHITE;
+        auto color = ColorOf(object);
 
         graphics.DrawCircle(color, center.x, center.y, radius);
     }
 
-    void Visit(PolylineObject& object) override {}
+    void Visit(const PolylineObject& object) override {}
+
+    // Pattern lines are only worked out for the part of the hatch on screen. Lines closer together than a couple of
+    // pixels would blend into a fill anyway, so then the hatch is filled instead, as is a solid one.
+    void Visit(const HatchObject& object) override {
+        auto color = ColorOf(object);
+        Core::Transform transform = graphics.GetTransform();
+        if (object.spacing * std::abs(transform.scale) < 2) {
+            graphics.FillPolygon(color, object.loops, object.rule);
+            return;
+        }
+        Core::Transform inverse = transform.Inverse();
+        float width = graphics.GetWidth(), height = graphics.GetHeight();
+        Core::Bounds screen;
+        for (Core::Vector2 corner : {Core::Vector2(0, 0), Core::Vector2(width, 0), Core::Vector2(0, height),
+                 Core::Vector2(width, height)}) {
+            screen.Expand(inverse.Apply(corner));
+        }
+        object.PatternLines(screen, [this, color](Core::Vector2 a, Core::Vector2 b) {
+            graphics.DrawLine(color, a.x, a.y, b.x, b.y);
+        });
+    }
+
+    // The block is drawn through the insert's transform on top of whatever transform is already in place. Culling
+    // happens before this, against the insert's bounds, so instances off screen never get here; instances that come
+    // out smaller than a couple of pixels are drawn as a single dot rather than walking the block.
+    void Visit(const InsertObject& object) override {
+        const InsertObject* outer = instance;
+        if (outer == nullptr) instance = &object;
+        Core::Transform transform = graphics.GetTransform() * object.transform;
+        Core::Vector2 size = object.block->bounds.GetSize() * transform.scale;
+        if (std::max(size.x, size.y) < 2) {
+            Core::Vector2 center = object.transform.Apply(object.block->bounds.GetCenter());
+            graphics.DrawLine(ColorOf(object), center.x, center.y, center.x, center.y);
+            instance = outer;
+            return;
+        }
+        graphics.PushTransform(transform);
+        object.block->VisitObjects(*this);
+        graphics.PopTransform();
+        instance = outer;
+    }
 };
 } // namespace Cad
\ No newline at end of file
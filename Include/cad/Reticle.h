@@ -9,6 +9,8 @@ namespace Cad {
     Midpoint,
     Endpoint,
     Intersection,
+    Center,
+    Quadrant,
     None
 };
 
@@ -36,4 +38,12 @@ struct EndpointReticle : public Reticle {
 struct IntersectionReticle : public Reticle {
     void Draw(Core::Controller& controller, Core::Vector2 screen_point) override;
 };
+
+struct CenterReticle : public Reticle {
+    void Draw(Core::Controller& controller, Core::Vector2 screen_point) override;
+};
+
+struct QuadrantReticle : public Reticle {
+    void Draw(Core::Controller& controller, Core::Vector2 screen_point) override;
+};
 } // namespace Cad
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cad/Controller.h>
+#include <core/graphics/Image.h>
+
+#include <cstdint>
+#include <memory>
+
+namespace Cad {
+
+// Ghost of the selection that follows the cursor while it is being moved or copied. The selected objects are drawn
+// once into an offscreen image and every frame after that the image is copied to the screen at the drag offset, so a
+// frame costs the same however much is selected. The image covers the screen plus a screen's width and height around
+// it. It is drawn again when the zoom, the drawing or the selection changes, or when the drag takes the selection
+// past that margin.
+class SelectionPreview {
+    std::unique_ptr<Core::Image> image;
+    // World position of the image's top left corner, and the view, drawing and selection it was made for
+    Core::Vector2 origin;
+    Core::Transform view;
+    uint64_t revision = 0;
+    uint64_t selection_revision = 0;
+
+    void Capture(Cad::Controller& controller, Core::Vector2 delta);
+
+  public:
+    SelectionPreview() = default;
+
+    // Draw the selection moved by the world space offset
+    void Draw(Cad::Controller& controller, Core::Vector2 delta);
+    void Reset() { image.reset(); }
+};
+
+} // namespace Cad
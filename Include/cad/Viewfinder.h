@@ -23,7 +23,8 @@ class Viewfinder {
 
     Cursor& GetCursor() { return *cursor; }
     Core::Vector2 GetCursor(Core::Controller& controller);
-    void Update(Core::Controller& controller, ObjectRegistry& registry, RayBank& ray_bank);
+    void Update(Core::Controller& controller, ObjectRegistry& registry, RayBank& ray_bank, const SnapIndex& snaps,
+        const IntersectionIndex& intersections);
     void Render(Core::Controller& controller, ObjectRegistry& registry, RayBank& ray_bank);
     Core::Transform GetViewTransform();
 };
@@ -20,8 +20,8 @@ struct Minimap : public Component {
         image_graphics.PushClip(x, y, width, height);
         image_graphics.FillRect(Core::Color::BLACK, x, y, width, height);
         image_graphics.PushTransform(minimap_transform);
-        RendererVisitor minimap_renderer(image_graphics);
-        controller.GetRegistry().VisitObjects(minimap_renderer);
+        RendererVisitor minimap_renderer(image_graphics, controller.GetRegistry());
+        controller.GetRegistry().VisitObjects(minimap_renderer, LayerFilter::Visible);
         image_graphics.PopTransform();
         image_graphics.DrawRect(Core::Color::WHITE, x, y, width, height);
         image_graphics.PopClip();
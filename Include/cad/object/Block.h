@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cad/object/ObjectVariant.h>
+#include <cad/object/ObjectVisitor.h>
+
+#include <string>
+#include <vector>
+
+namespace Cad {
+
+// Named group of objects in block space, placed into the drawing by InsertObjects. A definition is immutable once
+// built so any number of inserts (and snapshots) can share it; redefining a block makes a new definition and leaves
+// existing inserts pointing at the old one.
+struct BlockDefinition {
+    std::string name;
+    // Packed by value, drawing an instance walks a contiguous array rather than chasing one pointer per object
+    std::vector<ObjectVariant> objects;
+    // Union of the objects' bounds in block space
+    Core::Bounds bounds;
+
+    BlockDefinition(std::string name, std::vector<ObjectVariant> objects)
+        : name(std::move(name)), objects(std::move(objects)) {
+        for (auto& object : this->objects) {
+            bounds.Expand(std::visit([](const auto& concrete) { return concrete.GetBounds(); }, object));
+        }
+    }
+
+    void VisitObjects(ConstObjectVisitor& visitor) const {
+        for (auto& object : objects) {
+            std::visit([&visitor](const auto& concrete) { visitor.Visit(concrete); }, object);
+        }
+    }
+
+    template <typename F> void Visit(F&& function) const {
+        for (auto& object : objects) {
+            std::visit(function, object);
+        }
+    }
+};
+
+} // namespace Cad
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <core/math/Bounds.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Cad {
+
+// Bounded ring buffer of registry changes. Consumers (renderers, indexes, caches, autosave) keep a cursor and read
+// the records written since they last looked; when a consumer falls further behind than the capacity its records are
+// gone and it has to rebuild from the registry instead.
+template <typename Handle> class ChangeJournal {
+  public:
+    enum class Type {
+        Created,
+        Deleted,
+        Modified,
+    };
+
+    struct Record {
+        Type type;
+        Handle handle;
+        // The registry revision this change produced
+        uint64_t revision;
+        // Bounds of the object before the change, empty for created objects
+        Core::Bounds old_bounds;
+    };
+
+    // Position in the journal, counts every record ever written
+    using Cursor = uint64_t;
+
+  private:
+    std::vector<Record> ring;
+    size_t capacity;
+    // Sequence number of the next record, and of the oldest record that can still be held
+    Cursor head = 0;
+    Cursor base = 0;
+
+  public:
+    ChangeJournal(size_t capacity = 1 << 14) : capacity(capacity == 0 ? 1 : capacity) {}
+
+    void Write(Type type, Handle handle, uint64_t revision, Core::Bounds old_bounds) {
+        if (ring.size() != capacity) ring.resize(capacity);
+        ring[head % capacity] = Record{type, std::move(handle), revision, old_bounds};
+        head++;
+    }
+
+    // A cursor positioned after every record written so far
+    Cursor GetCursor() const { return head; }
+
+    // True if every record after the cursor is still held in the ring
+    bool IsAvailable(Cursor cursor) const { return cursor >= base && cursor <= head && head - cursor <= capacity; }
+
+    // Hand every record after the cursor to the function in order and advance the cursor. Returns false without
+    // reading anything if records were already overwritten, the cursor is then moved to the head so the caller can
+    // rebuild and continue from there.
+    template <typename F> bool Read(Cursor& cursor, F&& function) const {
+        if (!IsAvailable(cursor)) {
+            cursor = head;
+            return false;
+        }
+        for (; cursor < head; cursor++) {
+            function(ring[cursor % capacity]);
+        }
+        return true;
+    }
+
+    // Drops every record, outstanding cursors will be told to rebuild on their next read
+    void SetCapacity(size_t new_capacity) {
+        capacity = new_capacity == 0 ? 1 : new_capacity;
+        ring.clear();
+        ring.shrink_to_fit();
+        head++;
+        base = head;
+    }
+
+    size_t GetCapacity() const { return capacity; }
+};
+
+} // namespace Cad
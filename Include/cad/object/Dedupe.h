@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cad/object/ObjectRegistry.h>
+
+#include <vector>
+
+namespace Cad {
+
+// Objects that add nothing to the drawing. Only objects on the same layer are compared, and of a group of duplicates
+// the oldest (lowest ID) is the one kept.
+struct RedundantObjects {
+    // Same geometry as another object, up to the tolerance and the direction of lines and polylines
+    std::vector<ObjectId> duplicates;
+    // Lines lying entirely on another line
+    std::vector<ObjectId> overlapped;
+
+    size_t Count() const { return duplicates.size() + overlapped.size(); }
+};
+
+// Duplicates are found by hashing each object's geometry, quantized to the tolerance and put in a canonical order,
+// in parallel over the registry and then grouping equal hashes. Overlapping lines are found by querying the layer
+// spatial indexes around every line, also in parallel. The registry must not change while this runs.
+RedundantObjects FindRedundantObjects(
+    const ObjectRegistry& registry, float tolerance = 1e-5f, LayerFilter filter = LayerFilter::Editable);
+
+} // namespace Cad
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cad/object/ObjectRegistry.h>
+
+#include <optional>
+#include <vector>
+
+namespace Cad {
+
+// Trim, extend and offset. The boundaries an object is cut or extended to are the other visible objects. They are
+// found through the layer spatial indexes along the piece being edited, never by a pass over the drawing, and cut
+// with the intersection functions of core/math/Geometry.h. Every result is worked out against the drawing as it was
+// before any of them is written, and they are all written as one undo step. Each function returns how many objects
+// it changed or created.
+
+// Point on an object at which to trim it
+struct TrimPick {
+    ObjectId id;
+    Core::Vector2 point;
+};
+
+// Remove the piece of each object around each of its picks, up to the nearest places on either side where other
+// objects cross it. A piece with no crossing on one side goes all the way to that end, so an object nothing crosses
+// is removed whole, and so is a circle or closed polyline crossed only once. What is left of a circle becomes a
+// polyline arc, since there is no arc object.
+size_t TrimObjects(ObjectRegistry& registry, const std::vector<TrimPick>& picks);
+
+// Picks wherever the fence from a to b crosses an editable line, circle or polyline
+std::vector<TrimPick> FencePicks(const ObjectRegistry& registry, Core::Vector2 a, Core::Vector2 b);
+
+// Lengthen lines and open polylines until they meet the nearest boundary straight ahead. Both ends are extended, or
+// only the end closer to the point if there is one. Ends with nothing ahead of them stay where they are.
+size_t ExtendObjects(
+    ObjectRegistry& registry, const std::vector<ObjectId>& ids, std::optional<Core::Vector2> toward = std::nullopt);
+
+// Parallel copies at the distance, on the side of lines and polylines a quarter turn counterclockwise from the way
+// they run and outside circles for a positive distance. Polyline corners are mitred; a copy that folds back on itself
+// at a tight corner is not cleaned up.
+size_t OffsetObjects(ObjectRegistry& registry, const std::vector<ObjectId>& ids, float distance);
+
+} // namespace Cad
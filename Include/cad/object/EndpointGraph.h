@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cad/object/IdIndex.h>
+#include <cad/object/ObjectRegistry.h>
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace Cad {
+
+// Which lines and polylines meet at which points. Endpoints are bucketed on a grid the size of the join tolerance,
+// so the ends meeting at a point are found by looking at the 3x3 cells around it instead of scanning the drawing.
+// The graph is optional: it is brought up to date from the registry's journal when Sync is called, touching only
+// what changed since the last call, and costs nothing while nobody uses it.
+class EndpointGraph {
+  public:
+    // One end of an object, side 0 is where it starts and side 1 where it finishes
+    struct End {
+        ObjectId id;
+        int side;
+        Core::Vector2 point;
+    };
+
+    // Step of a chain, reversed objects are walked from their last point to their first
+    struct Link {
+        ObjectId id;
+        bool reversed;
+    };
+
+  private:
+    struct Cell {
+        int64_t x, y;
+        bool operator==(const Cell& other) const { return x == other.x && y == other.y; }
+    };
+
+    struct CellHash {
+        size_t operator()(const Cell& cell) const {
+            return std::hash<int64_t>()(cell.x * 73856093 ^ cell.y * 19349663);
+        }
+    };
+
+    struct Ends {
+        Core::Vector2 points[2];
+    };
+
+    float tolerance;
+    std::unordered_map<Cell, std::vector<End>, CellHash> cells;
+    // Endpoints of every object in the graph, needed to find its entries again once it has changed
+    IdIndex<Ends> objects;
+
+    ObjectRegistry::Journal::Cursor cursor = 0;
+    bool synced = false;
+
+    Cell CellOf(Core::Vector2 point) const;
+    void Add(const Object& object);
+    void Remove(ObjectId id);
+    void Rebuild(const ObjectRegistry& registry);
+
+    // The end of an object that continues the chain from the given end, if exactly one does
+    const End* Continuation(
+        const End& end, const std::function<bool(ObjectId)>& accept, std::vector<End>& scratch) const;
+
+  public:
+    EndpointGraph(float tolerance = 1e-4f) : tolerance(tolerance) {}
+
+    // Apply the registry's changes since the last sync, or rebuild if the journal no longer has them
+    void Sync(const ObjectRegistry& registry);
+
+    // Ends lying within the tolerance of the point
+    std::vector<End> EndsAt(Core::Vector2 point) const;
+
+    // Objects connected end to end with the seed, in order. The walk continues through points where exactly two ends
+    // meet, so it stops at open ends and at branches, and it only takes objects the filter accepts. Runs in time
+    // proportional to the length of the chain.
+    std::vector<Link> Chain(ObjectId seed, const std::function<bool(ObjectId)>& accept = nullptr) const;
+
+    // Ends that no other end meets
+    std::vector<End> OpenEnds() const;
+
+    // Start and end of a chainable object (a line, or a polyline with at least two points)
+    static bool GetEnds(const Object& object, Core::Vector2& start, Core::Vector2& end);
+
+    float GetTolerance() const { return tolerance; }
+    size_t Count() const { return objects.Count(); }
+};
+
+} // namespace Cad
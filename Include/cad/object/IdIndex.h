@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cad/object/Object.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Cad {
+
+// Open addressing hash map from object IDs to values. Linear probing over a power of two table that is kept at most
+// half full; removal shifts the rest of the probe run back instead of leaving tombstones, so lookups stay short no
+// matter how many objects have come and gone. NULL_ID marks an empty slot and cannot be used as a key.
+template <typename T> class IdIndex {
+    struct Slot {
+        ObjectId id = NULL_ID;
+        T value{};
+    };
+
+    std::vector<Slot> slots;
+    size_t count = 0;
+
+    // IDs are sequential, mix them so that runs of new objects don't land in one run of slots
+    static size_t Hash(ObjectId id) {
+        id ^= id >> 33;
+        id *= 0xff51afd7ed558ccdULL;
+        id ^= id >> 33;
+        return size_t(id);
+    }
+
+    size_t Mask() const { return slots.size() - 1; }
+
+    size_t FindSlot(ObjectId id) const {
+        size_t i = Hash(id) & Mask();
+        while (slots[i].id != NULL_ID && slots[i].id != id) {
+            i = (i + 1) & Mask();
+        }
+        return i;
+    }
+
+    void Rehash(size_t capacity) {
+        std::vector<Slot> old = std::move(slots);
+        slots.assign(capacity, Slot());
+        for (Slot& slot : old) {
+            if (slot.id != NULL_ID) slots[FindSlot(slot.id)] = std::move(slot);
+        }
+    }
+
+  public:
+    IdIndex() : slots(16) {}
+
+    // Size the table for the given number of entries up front
+    void Reserve(size_t entries) {
+        size_t capacity = slots.size();
+        while (capacity < entries * 2) {
+            capacity *= 2;
+        }
+        if (capacity != slots.size()) Rehash(capacity);
+    }
+
+    // Insert or overwrite
+    void Insert(ObjectId id, T value) {
+        if ((count + 1) * 2 > slots.size()) Rehash(slots.size() * 2);
+        Slot& slot = slots[FindSlot(id)];
+        if (slot.id == NULL_ID) count++;
+        slot.id = id;
+        slot.value = std::move(value);
+    }
+
+    bool Remove(ObjectId id) {
+        size_t hole = FindSlot(id);
+        if (slots[hole].id == NULL_ID) return false;
+
+        // Walk the rest of the run and move back every entry whose home slot is not between the hole and itself
+        for (size_t i = (hole + 1) & Mask(); slots[i].id != NULL_ID; i = (i + 1) & Mask()) {
+            size_t home = Hash(slots[i].id) & Mask();
+            bool stays = hole < i ? (hole < home && home <= i) : (hole < home || home <= i);
+            if (stays) continue;
+            slots[hole] = std::move(slots[i]);
+            hole = i;
+        }
+        slots[hole] = Slot();
+        count--;
+        return true;
+    }
+
+    // Value stored for the ID, nullptr if there is none
+    const T* Find(ObjectId id) const {
+        if (id == NULL_ID) return nullptr;
+        const Slot& slot = slots[FindSlot(id)];
+        return slot.id == NULL_ID ? nullptr : &slot.value;
+    }
+
+    T* Find(ObjectId id) { return const_cast<T*>(static_cast<const IdIndex&>(*this).Find(id)); }
+
+    void Clear() {
+        slots.assign(slots.size(), Slot());
+        count = 0;
+    }
+
+    size_t Count() const { return count; }
+};
+
+} // namespace Cad
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cad/object/IdIndex.h>
+#include <cad/object/ObjectRegistry.h>
+#include <cad/object/SpatialIndex.h>
+
+#include <vector>
+
+namespace Cad {
+
+// Every point where two pieces of geometry in the drawing cross or touch, kept in a point index for intersection
+// snapping. The points are found with a Bentley-Ottmann sweep over the segments of lines and polylines and the two
+// halves of every circle, in O((n + k) log n) for n pieces and k intersections. Like the EndpointGraph it is brought
+// up to date from the registry's journal on Sync: the changed objects and the objects around them are swept again
+// and only intersections involving a changed object are replaced.
+class IntersectionIndex {
+  public:
+    // Piece of an object's outline, inserts contribute the pieces of their block placed in world space
+    struct Primitive {
+        enum class Kind {
+            Segment,
+            Circle,
+        };
+
+        Kind kind;
+        // Segment ends, or the center of a circle in a
+        Core::Vector2 a, b;
+        float radius;
+        ObjectId owner;
+    };
+
+    // Two primitives meeting at a point, as indices into the swept list
+    struct Crossing {
+        Core::Vector2 point;
+        uint32_t first, second;
+    };
+
+    struct Intersection {
+        Core::Vector2 point;
+        // The same object twice for a polyline (or block) crossing itself
+        ObjectId a, b;
+    };
+
+  private:
+    // Slots of removed intersections are reused
+    std::vector<Intersection> intersections;
+    std::vector<uint32_t> free_slots;
+    SpatialIndex<uint32_t> points;
+    // Slots of the intersections each object takes part in
+    IdIndex<std::vector<uint32_t>> by_object;
+
+    ObjectRegistry::Journal::Cursor cursor = 0;
+    bool synced = false;
+
+    void Add(const Intersection& intersection);
+    void Remove(ObjectId id);
+    void Rebuild(const ObjectRegistry& registry);
+    void Update(const ObjectRegistry& registry, const std::vector<ObjectId>& changed);
+
+  public:
+    IntersectionIndex() = default;
+
+    // Apply the registry's changes since the last sync, or rebuild if the journal no longer has them or too much of
+    // the drawing has changed for a partial sweep to pay off
+    void Sync(const ObjectRegistry& registry);
+
+    // Call the function with every intersection inside the rect
+    template <typename F> void Query(const Core::Bounds& rect, F&& function) const {
+        points.Query(rect, [this, &function](uint32_t slot, const Core::Bounds&) { function(intersections[slot]); });
+    }
+
+    size_t Count() const { return points.Count(); }
+
+    // Append the pieces of the object's outline
+    static void Decompose(const Object& object, std::vector<Primitive>& primitives);
+
+    // Every point where two of the primitives meet, leaving out the vertices an object's own segments share
+    static std::vector<Crossing> Sweep(const std::vector<Primitive>& primitives);
+};
+
+} // namespace Cad
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <core/graphics/Pixel.h>
+
+#include <string>
+
+namespace Cad {
+
+using LayerId = unsigned int;
+
+// Which layers a registry query should look at
+enum class LayerFilter {
+    All,
+    Visible,
+    Editable,
+};
+
+// Display and editing attributes shared by every object on a layer. Hidden layers are neither drawn, snapped to nor
+// selectable; locked layers are drawn and snapped to but cannot be selected for editing.
+struct Layer {
+    std::string name;
+    bool visible = true;
+    bool locked = false;
+    Core::Pixel color = Core::Color::WHITE;
+
+    Layer(std::string name) : name(std::move(name)) {}
+
+    bool Accepts(LayerFilter filter) const {
+        switch (filter) {
+        case LayerFilter::All: return true;
+        case LayerFilter::Visible: return visible;
+        case LayerFilter::Editable: return visible && !locked;
+        }
+        return true;
+    }
+};
+
+} // namespace Cad
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cad/object/ObjectMetrics.h>
+#include <cad/object/ObjectRegistry.h>
+
+#include <array>
+#include <optional>
+
+namespace Cad {
+
+// Aggregates over a set of objects. Sums are kept in double, a drawing of a million small segments would lose most
+// of its total in a float.
+struct Measurement {
+    size_t count = 0;
+    // Indexed by ObjectType
+    std::array<size_t, 5> by_type{};
+    // See ObjectLength and ObjectArea
+    double length = 0;
+    double area = 0;
+    // Union of the objects' bounds, empty if there are none
+    Core::Bounds extents;
+
+    template <typename T> void Add(const T& object);
+    void Merge(const Measurement& other);
+};
+
+// Measure every object the query matches. The registry is split across the shared thread pool, each partition
+// measures its share into its own Measurement and the partials are merged at the end, so no state is shared while
+// the pass runs. The registry must not change meanwhile.
+Measurement Measure(const ObjectRegistry& registry, const Query& query);
+
+// Measurements of the whole drawing and of the selection, remembered against the registry revision, and for the
+// selection also the selection revision. Changing anything bumps them, so a cached result is returned only while it is
+// still exact and asking again on an unchanged drawing costs nothing.
+class MeasurementCache {
+  public:
+    enum class Scope {
+        Drawing,
+        Selection,
+    };
+
+  private:
+    struct Cached {
+        uint64_t revision;
+        uint64_t selection_revision;
+        Measurement measurement;
+    };
+
+    std::array<std::optional<Cached>, 2> cached;
+
+  public:
+    const Measurement& Get(const ObjectRegistry& registry, Scope scope);
+};
+
+template <typename T> void Measurement::Add(const T& object)
+{
+    count++;
+    by_type[size_t(object.GetType())]++;
+    length += ObjectLength(object);
+    area += ObjectArea(object);
+    extents.Expand(object.T::GetBounds());
+}
+
+} // namespace Cad
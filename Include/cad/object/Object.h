@@ -1,7 +1,13 @@
 #pragma once
 
+#include <cad/object/Layer.h>
+#include <cad/object/ObjectPool.h>
+#include <core/math/Bounds.h>
+#include <core/math/Geometry.h>
+#include <core/math/Transform.h>
 #include <core/math/Vector2.h>
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
@@ -9,32 +15,50 @@
 namespace Cad {
 
 struct ObjectVisitor;
+struct ConstObjectVisitor;
+struct BlockDefinition;
+
+// Identity of an object for as long as it exists, assigned by the registry and never reused. Unlike a registry
+// reference it is a plain value, so it can be stored in commands, journals and files or handed to other threads.
+using ObjectId = uint64_t;
+constexpr ObjectId NULL_ID = 0;
+
+// The closed set of concrete object kinds, used to dispatch without going through a visitor
+enum class ObjectType {
+    Line,
+    Circle,
+    Polyline,
+    Insert,
+    Hatch,
+};
 
 class Object {
-    bool is_selected = false;
-    public:
+    friend class ObjectRegistry;
+
+    ObjectType type;
+    // Only the registry moves objects between layers, it has to keep the layer indexes in step
+    LayerId layer = 0;
+    ObjectId id = NULL_ID;
 
+  protected:
+    Object(ObjectType type) : type(type) {}
+
+  public:
     virtual ~Object() = default;
+    ObjectType GetType() const { return type; }
     virtual void Accept(ObjectVisitor& visitor) = 0;
+    virtual void Accept(ConstObjectVisitor& visitor) const = 0;
     virtual std::unique_ptr<Object> Clone() const = 0;
     virtual std::string ToString() const = 0;
+    virtual Core::Bounds GetBounds() const = 0;
 
-    bool IsSelected() const {
-        return is_selected;
-    }
-
-    void Select() {
-        is_selected = true;
-    }
-
-    void Deselect() {
-        is_selected = false;
-    }
+    LayerId GetLayer() const { return layer; }
+    ObjectId GetId() const { return id; }
 };
 
 struct ObjectPredicate {
     virtual ~ObjectPredicate() = default;
-    virtual bool Match(Object& object) = 0;
+    virtual bool Match(const Object& object) = 0;
 };
 
 struct LineObject : public Object {
@@ -42,10 +66,15 @@ struct LineObject : public Object {
     Core::Vector2 end;
 
     LineObject(Core::Vector2 start, Core::Vector2 end);
-    
+
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
+
     void Accept(ObjectVisitor& visitor) override;
+    void Accept(ConstObjectVisitor& visitor) const override;
     std::unique_ptr<Object> Clone() const override;
     std::string ToString() const override;
+    Core::Bounds GetBounds() const override;
 };
 
 struct CircleObject : public Object {
@@ -54,19 +83,104 @@ struct CircleObject : public Object {
 
     CircleObject(Core::Vector2 center, float radius);
 
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
+
     void Accept(ObjectVisitor& visitor) override;
+    void Accept(ConstObjectVisitor& visitor) const override;
     std::unique_ptr<Object> Clone() const override;
     std::string ToString() const override;
+    Core::Bounds GetBounds() const override;
 };
 
 struct PolylineObject : public Object {
-    std::vector<Core::Vector2> points;
+    VertexList points;
+
+    PolylineObject(VertexList points);
+
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
+
+    void Accept(ObjectVisitor& visitor) override;
+    void Accept(ConstObjectVisitor& visitor) const override;
+    std::unique_ptr<Object> Clone() const override;
+    std::string ToString() const override;
+    Core::Bounds GetBounds() const override;
+};
+
+// Placement of a block definition. The geometry stays in the (shared, immutable) definition, an insert only carries
+// the transform from block space to world space, so repeating a part costs one small object per instance.
+struct InsertObject : public Object {
+    std::shared_ptr<const BlockDefinition> block;
+    Core::Transform transform;
+
+    InsertObject(std::shared_ptr<const BlockDefinition> block, Core::Transform transform);
+
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
+
+    void Accept(ObjectVisitor& visitor) override;
+    void Accept(ConstObjectVisitor& visitor) const override;
+    std::unique_ptr<Object> Clone() const override;
+    std::string ToString() const override;
+    Core::Bounds GetBounds() const override;
+};
 
-    PolylineObject(std::vector<Core::Vector2> points);
+// Region filled solid or with parallel pattern lines. As in a DXF hatch the outline is kept on the hatch itself, as
+// closed loops (circles tessellated), together with the IDs of the objects it was traced from. Copies of the hatch
+// don't keep the IDs, and neither does the hatch once it is moved without those objects. The pattern lines are never
+// stored: PatternLines works out the ones needed from the loops one scanline at a time, so a hatch costs the same
+// however fine its pattern is.
+struct HatchObject : public Object {
+    std::vector<std::vector<Core::Vector2>> loops;
+    std::vector<ObjectId> boundaries;
+    Core::FillRule rule;
+    // Direction of the pattern lines in radians and the distance between them, solid if the spacing is 0. The lines
+    // are laid out from the world origin, so neighbouring hatches with the same pattern line up.
+    float angle;
+    float spacing;
+
+    HatchObject(std::vector<std::vector<Core::Vector2>> loops, std::vector<ObjectId> boundaries, float angle,
+        float spacing, Core::FillRule rule = Core::FillRule::EvenOdd);
+
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
 
     void Accept(ObjectVisitor& visitor) override;
+    void Accept(ConstObjectVisitor& visitor) const override;
     std::unique_ptr<Object> Clone() const override;
     std::string ToString() const override;
+    Core::Bounds GetBounds() const override;
+
+    bool IsSolid() const { return !(spacing > 0); }
+    // Call the function with the ends of every piece of pattern line inside the hatch, cut down to the part within
+    // the region. Only the lines that cross the region are worked out. Nothing for a solid hatch.
+    void PatternLines(
+        const Core::Bounds& region, const std::function<void(Core::Vector2, Core::Vector2)>& function) const;
 };
 
-}
\ No newline at end of file
+// Affine matrices act on objects through a batch of their points, so that many objects can be transformed in one
+// vectorized pass: gather the points of every object, transform the batch, then scatter it back in the same order.
+// Circles and inserts only scale uniformly, by the square root of the determinant, and inserts turn with the x axis.
+// A mirrored insert is moved and turned but not flipped, Transform has no reflection.
+struct PointScatter {
+    const Core::PointBatch& points;
+    const Core::Matrix3& matrix;
+    size_t next = 0;
+    float scale;
+    float rotation;
+
+    PointScatter(const Core::PointBatch& points, const Core::Matrix3& matrix);
+
+    Core::Vector2 Next();
+    // Angle of the direction at the given angle once the matrix has acted on it, right for mirrors too
+    float Direction(float angle) const;
+};
+
+void GatherPoints(const Object& object, Core::PointBatch& points);
+void ScatterPoints(Object& object, PointScatter& scatter);
+
+// The same for a single object
+void TransformObject(Object& object, const Core::Matrix3& matrix);
+
+}
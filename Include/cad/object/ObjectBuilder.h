@@ -29,13 +29,43 @@ struct CircleObjectBuilder : ObjectBuilder {
     }
 };
 
+// The vertex storage is handed over to the built object rather than copied, so a builder can only be built once
 struct PolylineObjectBuilder : ObjectBuilder {
-    std::vector<Core::Vector2> points;
+    VertexList points;
 
-    PolylineObjectBuilder(std::vector<Core::Vector2> points) : points(points) {}
+    PolylineObjectBuilder(VertexList points) : points(std::move(points)) {}
 
     std::unique_ptr<Object> Build() override {
-        return std::make_unique<PolylineObject>(points);
+        return std::make_unique<PolylineObject>(std::move(points));
     }
 };
-}
\ No newline at end of file
+
+struct InsertObjectBuilder : ObjectBuilder {
+    std::shared_ptr<const BlockDefinition> block;
+    Core::Transform transform;
+
+    InsertObjectBuilder(std::shared_ptr<const BlockDefinition> block, Core::Transform transform)
+        : block(std::move(block)), transform(transform) {}
+
+    std::unique_ptr<Object> Build() override {
+        return std::make_unique<InsertObject>(block, transform);
+    }
+};
+
+// Like the polyline builder, the loops are handed over to the built object
+struct HatchObjectBuilder : ObjectBuilder {
+    std::vector<std::vector<Core::Vector2>> loops;
+    std::vector<ObjectId> boundaries;
+    float angle;
+    float spacing;
+    Core::FillRule rule;
+
+    HatchObjectBuilder(std::vector<std::vector<Core::Vector2>> loops, std::vector<ObjectId> boundaries, float angle,
+        float spacing, Core::FillRule rule = Core::FillRule::EvenOdd)
+        : loops(std::move(loops)), boundaries(std::move(boundaries)), angle(angle), spacing(spacing), rule(rule) {}
+
+    std::unique_ptr<Object> Build() override {
+        return std::make_unique<HatchObject>(std::move(loops), std::move(boundaries), angle, spacing, rule);
+    }
+};
+}
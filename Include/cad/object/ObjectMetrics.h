@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cad/object/Object.h>
+
+namespace Cad {
+
+// Length of the drawn outline: a line's length, a circle's circumference, the sum of a polyline's segments. Inserts
+// measure their block in block space and scale the result. Hatches count nothing, their outline is that of the
+// objects they were traced from.
+float ObjectLength(const LineObject& line);
+float ObjectLength(const CircleObject& circle);
+float ObjectLength(const PolylineObject& polyline);
+float ObjectLength(const InsertObject& insert);
+float ObjectLength(const HatchObject& hatch);
+float ObjectLength(const Object& object);
+
+// Area enclosed by the object: a circle's disc, a closed polyline's polygon (first and last point equal), zero for
+// lines and open polylines. Self-intersecting polylines give the signed shoelace sum made positive. A hatch covers its
+// loops less the loops nested an odd number of levels inside others.
+float ObjectArea(const LineObject& line);
+float ObjectArea(const CircleObject& circle);
+float ObjectArea(const PolylineObject& polyline);
+float ObjectArea(const InsertObject& insert);
+float ObjectArea(const HatchObject& hatch);
+float ObjectArea(const Object& object);
+
+// Distance from the point to the closest point of the drawn outline, so the inside of a circle or closed polyline is
+// not any nearer than the outside
+float ObjectDistance(const LineObject& line, Core::Vector2 point);
+float ObjectDistance(const CircleObject& circle, Core::Vector2 point);
+float ObjectDistance(const PolylineObject& polyline, Core::Vector2 point);
+float ObjectDistance(const InsertObject& insert, Core::Vector2 point);
+float ObjectDistance(const HatchObject& hatch, Core::Vector2 point);
+float ObjectDistance(const Object& object, Core::Vector2 point);
+
+// Whether the drawn outline touches the rect, anywhere along it. Unlike a bounds test a circle around the rect or a
+// diagonal line passing one of its corners does not count.
+bool ObjectCrosses(const LineObject& line, const Core::Bounds& rect);
+bool ObjectCrosses(const CircleObject& circle, const Core::Bounds& rect);
+bool ObjectCrosses(const PolylineObject& polyline, const Core::Bounds& rect);
+bool ObjectCrosses(const InsertObject& insert, const Core::Bounds& rect);
+bool ObjectCrosses(const HatchObject& hatch, const Core::Bounds& rect);
+bool ObjectCrosses(const Object& object, const Core::Bounds& rect);
+
+} // namespace Cad
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <core/math/Vector2.h>
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace Cad {
+
+// Fixed-size block allocator. Blocks are carved out of large chunks and recycled through an intrusive free list, so
+// allocating N blocks costs roughly N / blocks_per_chunk calls into the system allocator.
+class BlockPool {
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    std::size_t block_size;
+    std::size_t blocks_per_chunk;
+    std::vector<void*> chunks;
+    FreeBlock* free_list = nullptr;
+    std::mutex mutex;
+
+    void Grow();
+
+  public:
+    BlockPool(std::size_t block_size, std::size_t blocks_per_chunk = 1024);
+    ~BlockPool();
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    void* Allocate();
+    void Deallocate(void* block);
+
+    std::size_t GetBlockSize() const { return block_size; }
+    std::size_t GetChunkCount() const { return chunks.size(); }
+};
+
+// One pool per type, so objects of the same kind are packed together and never share a free list with another kind.
+// The pool is intentionally leaked: objects may still be released by other static destructors at shutdown.
+template <typename T> BlockPool& PoolFor() {
+    static BlockPool* pool = new BlockPool(sizeof(T));
+    return *pool;
+}
+
+// Standard allocator that routes single-element allocations through the type's pool, used for the registry entries
+// and their shared_ptr control blocks.
+template <typename T> struct PoolAllocator {
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <typename U> PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        if (n == 1) return static_cast<T*>(PoolFor<T>().Allocate());
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n) {
+        if (n == 1) {
+            PoolFor<T>().Deallocate(ptr);
+            return;
+        }
+        ::operator delete(ptr);
+    }
+
+    template <typename U> bool operator==(const PoolAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const PoolAllocator<U>&) const { return false; }
+};
+
+// Chunked arena for variable length vertex data. Requests are rounded up to a power of two size class and each class
+// is served by its own BlockPool; anything larger than the biggest class goes straight to the system allocator.
+class VertexArena {
+    static constexpr std::size_t MIN_CLASS_BYTES = 16;
+    static constexpr std::size_t CLASS_COUNT = 13; // 16 bytes .. 64 KiB
+    static constexpr std::size_t CHUNK_BYTES = 256 * 1024;
+
+    std::vector<BlockPool*> classes;
+
+    static std::size_t ClassOf(std::size_t bytes);
+
+  public:
+    VertexArena();
+    ~VertexArena();
+
+    void* Allocate(std::size_t bytes);
+    void Deallocate(void* ptr, std::size_t bytes);
+
+    static VertexArena& Get();
+};
+
+template <typename T> struct VertexAllocator {
+    using value_type = T;
+
+    VertexAllocator() = default;
+    template <typename U> VertexAllocator(const VertexAllocator<U>&) {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(VertexArena::Get().Allocate(n * sizeof(T))); }
+    void deallocate(T* ptr, std::size_t n) { VertexArena::Get().Deallocate(ptr, n * sizeof(T)); }
+
+    template <typename U> bool operator==(const VertexAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const VertexAllocator<U>&) const { return false; }
+};
+
+using VertexList = std::vector<Core::Vector2, VertexAllocator<Core::Vector2>>;
+
+} // namespace Cad
@@ -1,57 +1,308 @@
 #pragma once
 
+#include <cad/object/Block.h>
+#include <cad/object/ChangeJournal.h>
+#include <cad/object/IdIndex.h>
+#include <cad/object/Layer.h>
 #include <cad/object/Object.h>
 #include <cad/object/ObjectBuilder.h>
+#include <cad/object/ObjectTable.h>
+#include <cad/object/ObjectVariant.h>
+#include <cad/object/Query.h>
+#include <cad/object/RegistrySnapshot.h>
+#include <cad/object/SpatialIndex.h>
+#include <cad/object/UndoJournal.h>
+#include <core/math/Matrix3.h>
 
-#include <list>
+#include <optional>
+#include <vector>
 
 namespace Cad {
 
 class ObjectRegistry {
     struct Entry {
         friend class ObjectRegistry;
-        // The "underlying" object, an entry will only be considered valid if
-        // this is not null
-        std::unique_ptr<Object> object = nullptr;
+        static constexpr size_t INVALID = ~size_t(0);
 
-        // Only the registry can invalidate an entry
-        void Invalidate();
+        // Slot of the underlying object in the registry's table, an entry will only be considered valid if this is
+        // not INVALID. The user cannot access the underlying object directly, they must use the registry and visit
+        // it with a visitor.
+        size_t index = INVALID;
 
-        // The user cannot access the underlying object directly, they must use
-        // the registry and visit it with a visitor
-        Object& GetObject();
+        // Registry revision of the last change to this entry
+        uint64_t revision = 0;
 
-        Entry();
-        Entry(std::unique_ptr<Object> object);
-        bool NotValid() const;
+        // Kept after the object is deleted, so a stale reference still says what it referred to
+        ObjectId id = NULL_ID;
+
+        Entry() = default;
+        Entry(size_t index, ObjectId id) : index(index), id(id) {}
+        bool NotValid() const { return index == INVALID; }
     };
 
   public:
     using Reference = std::shared_ptr<Entry>;
+    using Journal = ChangeJournal<ObjectId>;
 
   private:
-    std::list<Reference> references;
+    // Per layer spatial index over the layer's objects, plus the union of their bounds (recomputed lazily once an
+    // object shrinks or leaves)
+    struct LayerIndex {
+        SpatialIndex<Entry*> index;
+        Core::Bounds bounds;
+        bool bounds_dirty = false;
+
+        LayerIndex() : index(1.0f) {}
+    };
+
+    // Object storage, shared with snapshots until written to
+    std::shared_ptr<ObjectTable> table;
+    // References by slot, references[i]->index == i
+    std::vector<Reference> references;
+    // Entries of live objects by ID
+    IdIndex<Entry*> ids;
+    ObjectId next_id = 1;
+
+    // Layer attributes by LayerId, shared with snapshots like the table; the indexes are registry only
+    std::shared_ptr<std::vector<Layer>> layers;
+    mutable std::vector<LayerIndex> layer_indexes;
+    LayerId current_layer = 0;
+
+    std::vector<std::shared_ptr<const BlockDefinition>> blocks;
+
+    // Bumped on every create, delete and modify; never goes backwards
+    uint64_t revision = 0;
+    Journal journal;
+
+    // IDs of the selected objects in no particular order, and where each one is in the list. The objects themselves
+    // don't know they are selected, so selecting neither copies them nor shows up in the journal.
+    std::vector<ObjectId> selection;
+    IdIndex<size_t> selection_slots;
+    // Bumped whenever an object joins or leaves the selection
+    uint64_t selection_revision = 0;
+
+    // Every public change to the objects is recorded here, see UndoJournal
+    UndoJournal history;
+
+    // Copy-on-write access, detaches the table, chunk and object from any snapshot that still shares them
+    ObjectTable& MutableTable();
+    std::shared_ptr<Object>& MutableSlot(size_t index);
+    Object& Write(Entry& entry);
+    const Object& Read(const Entry& entry) const { return table->Get(entry.index); }
+
+    // Swap the last object into the slot and shrink the table by one
+    void RemoveSlot(size_t index);
+    void RecordModified(Reference& reference, Core::Bounds old_bounds);
+    // The part of RecordModified that doesn't touch the layer indexes
+    void RecordRevision(Reference& reference, Core::Bounds old_bounds);
+    void UpdateSelection(ObjectId id, bool selected);
+
+    std::vector<Layer>& MutableLayers();
+    void LayerInsert(Entry* entry, LayerId layer, const Core::Bounds& bounds);
+    // Everything creating an object does except putting it in its layer index
+    Reference Adopt(std::unique_ptr<Object> object);
+    // Append an object that already has its ID and layer to the table
+    Reference Place(std::shared_ptr<Object> object);
+    void LayerRemove(Entry* entry, LayerId layer, const Core::Bounds& bounds);
+    void DeselectLayer(LayerId layer);
+    void SetSelected(const std::vector<Reference>& refs, bool selected);
+
+    // Undo and redo support. Take removes an object from the drawing and hands it over, Restore puts it back with its
+    // own ID, and Exchange swaps the object with that ID for another version of it.
+    void RecordBefore(const Entry& entry);
+    std::shared_ptr<Object> Take(Reference reference);
+    void Restore(std::shared_ptr<Object> object);
+    void Exchange(ObjectId id, std::shared_ptr<Object>& other);
+    void Replay(UndoJournal::Entry& entry, bool forward);
 
   public:
-    ObjectRegistry() = default;
+    ObjectRegistry();
     ~ObjectRegistry();
 
     // Create a new object and return a reference to it
     Reference CreateObject(ObjectBuilder& builder);
+    // Create many objects on the current layer at once. Storage for all of them is reserved up front and they are
+    // added to the layer index together at the end.
+    std::vector<Reference> CreateObjects(std::vector<std::unique_ptr<Object>> objects);
+
+    // Pre-size the reference storage ahead of a bulk import or copy
+    void Reserve(unsigned int count);
 
     // Given a reference, assuming it is still valid, invalidate it and delete the underlying object
     void DeleteObject(Reference reference);
     void DeleteObjects(std::vector<Reference> references);
 
-    // Given a reference, assuming it is still valid, use a visitor to visit the underlying object
-    void VisitObject(Reference reference, ObjectVisitor& visitor);
-    void VisitObjects(ObjectVisitor& visitor);
-    void VisitObjects(std::vector<Reference> refs, ObjectVisitor& visitor);
+    // Select or deselect objects, the ones already that way are left alone
+    void Select(const std::vector<Reference>& refs);
+    void Deselect(const std::vector<Reference>& refs);
+    void DeselectAll();
+
+    // Apply the affine matrix to the objects. Their points are gathered into one batch, transformed together and
+    // written back (see PointScatter), and the spatial indexes and journal are updated after.
+    void TransformObjects(const std::vector<Reference>& refs, const Core::Matrix3& matrix);
+    void TransformSelection(const Core::Matrix3& matrix) { TransformObjects(GetSelected(), matrix); }
+
+    // The selected objects, in no particular order
+    const std::vector<ObjectId>& GetSelection() const { return selection; }
+    std::vector<Reference> GetSelected() const { return Find(selection); }
+    bool IsSelected(ObjectId id) const { return selection_slots.Find(id) != nullptr; }
+    bool IsSelected(const Reference& reference) const { return IsSelected(reference->id); }
+
+    // Visit objects with a visitor that changes them. Unlike the Visit methods these bump the revision and record
+    // the change in the journal, so every mutation of registry objects should go through here.
+    void ModifyObject(Reference reference, ObjectVisitor& visitor);
+    void ModifyObjects(const std::vector<Reference>& refs, ObjectVisitor& visitor);
+
+    // Put another object in the place of the referenced one, which may be of a different kind. It takes over the ID,
+    // layer and selection, and is undone like any other modification.
+    void ReplaceObject(Reference reference, std::unique_ptr<Object> object);
+
+    template <typename F> void Modify(const std::vector<Reference>& refs, F&& function) {
+        history.Begin("modify");
+        for (auto reference : refs) {
+            if (reference->NotValid()) continue;
+            Core::Bounds old_bounds = Read(*reference).GetBounds();
+            RecordBefore(*reference);
+            Dispatch(Write(*reference), function);
+            RecordModified(reference, old_bounds);
+        }
+        history.End();
+    }
+
+    // Given a reference, assuming it is still valid, use a visitor to inspect the underlying object
+    void VisitObject(Reference reference, ConstObjectVisitor& visitor) const;
+    void VisitObjects(ConstObjectVisitor& visitor) const;
+    void VisitObjects(const std::vector<Reference>& refs, ConstObjectVisitor& visitor) const;
+
+    // Statically dispatched alternative to VisitObjects, the function is called with the concrete object type so
+    // a generic lambda (ie. [](auto& object) {...}) gets compiled once per object kind and inlined into the loop
+    template <typename F> void Visit(F&& function) const { table->Visit(function); }
+
+    template <typename F> void Visit(const std::vector<Reference>& refs, F&& function) const {
+        for (auto& reference : refs) {
+            if (reference->NotValid()) continue;
+            Dispatch(Read(*reference), function);
+        }
+    }
 
     // Test all underlying objects against a predicate and return a list of references to those that match
-    std::vector<Reference> QueryObjects(ObjectPredicate& predicate);
+    std::vector<Reference> QueryObjects(ObjectPredicate& predicate) const;
+
+    // Objects matching a composed query, see Query and CompiledQuery. Object kinds the query rules out are skipped
+    // on their tag, and when the query implies a rect only the spatial indexes of the layers it allows are searched,
+    // in which case the matches come back in no particular order.
+    std::vector<Reference> QueryObjects(const Query& query) const;
+    // Compile a query against the current layers, for passes that run it themselves
+    CompiledQuery Compile(const Query& query) const { return CompiledQuery(query, *layers, selection_slots); }
+
+    // Layer filtered reads, layers the filter rejects are skipped as a whole. The rect versions only look at objects
+    // whose bounds intersect the rect, using the layers' spatial indexes.
+    void VisitObjects(ConstObjectVisitor& visitor, LayerFilter filter) const;
+    void VisitObjects(const Core::Bounds& rect, ConstObjectVisitor& visitor, LayerFilter filter) const;
+    std::vector<Reference> QueryObjects(const Core::Bounds& rect, LayerFilter filter) const;
+    std::vector<Reference> QueryObjects(const Core::Bounds& rect, ObjectPredicate& predicate, LayerFilter filter) const;
+
+    // Object whose outline passes closest to the point, within the tolerance, or a null reference. Only objects whose
+    // bounds come within the tolerance are measured.
+    Reference Pick(Core::Vector2 point, float tolerance, LayerFilter filter) const;
+
+    // Statically dispatched rect query. It only reads (a layer whose cached bounds are stale is searched rather than
+    // recomputed), so several threads may run it at once while the registry is not being changed.
+    template <typename F> void Visit(const Core::Bounds& rect, LayerFilter filter, F&& function) const {
+        for (LayerId layer = 0; layer < layers->size(); layer++) {
+            if (!IsAccepted(layer, filter)) continue;
+            const LayerIndex& layer_index = layer_indexes[layer];
+            if (!layer_index.bounds_dirty && !layer_index.bounds.Intersects(rect)) continue;
+            layer_index.index.Query(
+                rect, [this, &function](Entry* entry, const Core::Bounds&) { Dispatch(Read(*entry), function); });
+        }
+    }
+
+    // Statically dispatched segment query, objects whose bounds the segment from a to b passes through
+    template <typename F> void Visit(Core::Vector2 a, Core::Vector2 b, LayerFilter filter, F&& function) const {
+        Core::Bounds rect = Core::Bounds::FromPoints(a, b);
+        for (LayerId layer = 0; layer < layers->size(); layer++) {
+            if (!IsAccepted(layer, filter)) continue;
+            const LayerIndex& layer_index = layer_indexes[layer];
+            if (!layer_index.bounds_dirty && !layer_index.bounds.Intersects(rect)) continue;
+            layer_index.index.QueryLine(
+                a, b, [this, &function](Entry* entry, const Core::Bounds&) { Dispatch(Read(*entry), function); });
+        }
+    }
+
+    // Parallel versions of VisitObjects and QueryObjects for read-only passes over large drawings. Visitors and
+    // predicates are constructed once per partition from the given arguments; the visitors are returned for the
+    // caller to merge and the matches come back in the same order QueryObjects would give them.
+    template <typename Visitor, typename... Args> std::vector<Visitor> ParallelVisitObjects(const Args&... args) const {
+        return table->ParallelVisitObjects<Visitor>(Core::ThreadPool::Shared(), args...);
+    }
+
+    template <typename Predicate, typename... Args>
+    std::vector<Reference> ParallelQueryObjects(const Args&... args) const {
+        std::vector<Reference> result;
+        for (size_t index : table->ParallelQueryObjects<Predicate>(Core::ThreadPool::Shared(), args...)) {
+            result.push_back(references[index]);
+        }
+        return result;
+    }
+
+    // Capture the current state of the drawing for readers on other threads, see RegistrySnapshot
+    RegistrySnapshot Snapshot() const;
 
     unsigned int Count() const;
     static Reference Null();
+
+    // Look an object up by ID, a null reference if no live object has it
+    Reference Find(ObjectId id) const;
+    std::vector<Reference> Find(const std::vector<ObjectId>& ids) const;
+    ObjectId GetId(const Reference& reference) const { return reference->id; }
+    LayerId LayerOf(const Reference& reference) const { return Read(*reference).GetLayer(); }
+    std::vector<ObjectId> GetIds(const std::vector<Reference>& refs) const;
+
+    // The drawing is unchanged for as long as the revision is. Selecting doesn't change the drawing, it has its own.
+    uint64_t GetRevision() const { return revision; }
+    uint64_t GetRevision(const Reference& reference) const { return reference->revision; }
+    uint64_t GetSelectionRevision() const { return selection_revision; }
+
+    // Layers, layer 0 always exists and new objects go on the current layer
+    LayerId CreateLayer(std::string name);
+    std::optional<LayerId> FindLayer(const std::string& name) const;
+    const Layer& GetLayer(LayerId layer) const { return (*layers)[layer]; }
+    unsigned int LayerCount() const { return layers->size(); }
+    unsigned int CountOnLayer(LayerId layer) const { return layer_indexes[layer].index.Count(); }
+    bool IsAccepted(LayerId layer, LayerFilter filter) const;
+
+    // Hiding or locking a layer also deselects its objects, they can no longer be edited
+    void SetLayerVisible(LayerId layer, bool visible);
+    void SetLayerLocked(LayerId layer, bool locked);
+    void SetLayerColor(LayerId layer, Core::Pixel color);
+    void SetCurrentLayer(LayerId layer) { current_layer = layer; }
+    LayerId GetCurrentLayer() const { return current_layer; }
+    void MoveToLayer(const std::vector<Reference>& refs, LayerId layer);
+
+    Core::Bounds GetLayerBounds(LayerId layer) const;
+    Core::Bounds GetBounds(LayerFilter filter = LayerFilter::All) const;
+
+    // Make a block from copies of the given objects, moved so that the base point becomes the block's origin. A block
+    // of the same name is replaced; inserts that already exist keep drawing the old definition.
+    std::shared_ptr<const BlockDefinition> DefineBlock(
+        std::string name, const std::vector<Reference>& refs, Core::Vector2 base_point);
+    std::shared_ptr<const BlockDefinition> FindBlock(const std::string& name) const;
+    unsigned int BlockCount() const { return blocks.size(); }
+
+    // Changes made until the matching EndChange are undone as one, instead of one per registry call. Amending merges
+    // them into the latest entry if it has the same label, for edits that are applied a step at a time.
+    void BeginChange(std::string label, bool amend = false) { history.Begin(std::move(label), amend); }
+    void EndChange() { history.End(); }
+
+    // Take back the latest change, or apply the latest one taken back, and return its label. Nothing happens while a
+    // change is open and has recorded something. Objects that come back into the drawing come back deselected.
+    std::optional<std::string> Undo();
+    std::optional<std::string> Redo();
+    const UndoJournal& GetHistory() const { return history; }
+    void SetUndoBudget(size_t bytes) { history.SetBudget(bytes); }
+
+    const Journal& GetJournal() const { return journal; }
+    void SetJournalCapacity(size_t capacity) { journal.SetCapacity(capacity); }
 };
-}
\ No newline at end of file
+} // namespace Cad
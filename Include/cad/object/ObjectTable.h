@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cad/object/Object.h>
+#include <cad/object/ObjectPool.h>
+#include <cad/object/ObjectVariant.h>
+#include <cad/object/ObjectVisitor.h>
+#include <core/thread/ThreadPool.h>
+
+#include <array>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace Cad {
+
+// Fixed size run of object slots. Chunks and the objects in them are shared between the registry and any snapshots
+// taken of it; the registry copies a chunk (or an object) only when it is about to write to one that is shared.
+struct ObjectChunk {
+    static constexpr size_t CAPACITY = 256;
+    std::array<std::shared_ptr<Object>, CAPACITY> objects;
+};
+
+// Two level array of objects, the storage behind ObjectRegistry and RegistrySnapshot. Copying a table only copies
+// the chunk pointers, so structurally it is shared until written to.
+struct ObjectTable {
+    std::vector<std::shared_ptr<ObjectChunk>> chunks;
+    size_t count = 0;
+
+    const Object& Get(size_t index) const { return *Share(index); }
+
+    // The owning pointer in the slot, for holding on to the object after it leaves the table
+    const std::shared_ptr<Object>& Share(size_t index) const {
+        return chunks[index / ObjectChunk::CAPACITY]->objects[index % ObjectChunk::CAPACITY];
+    }
+
+    void VisitObjects(ConstObjectVisitor& visitor) const {
+        for (size_t i = 0; i < count; i++) {
+            Get(i).Accept(visitor);
+        }
+    }
+
+    // Read-only pass split across the pool. One visitor is constructed per partition from the arguments, and the
+    // visitors are returned in storage order so the caller can merge whatever they collected.
+    template <typename Visitor, typename... Args>
+    std::vector<Visitor> ParallelVisitObjects(Core::ThreadPool& pool, const Args&... args) const {
+        static_assert(std::is_base_of_v<ConstObjectVisitor, Visitor>, "Parallel passes must use a ConstObjectVisitor");
+        unsigned partitions = pool.GetPartitionCount(count);
+        std::vector<Visitor> visitors;
+        visitors.reserve(partitions);
+        for (unsigned p = 0; p < partitions; p++) {
+            visitors.emplace_back(args...);
+        }
+        pool.ParallelFor(count, partitions, [this, &visitors](size_t begin, size_t end, unsigned partition) {
+            for (size_t i = begin; i < end; i++) {
+                Get(i).Accept(visitors[partition]);
+            }
+        });
+        return visitors;
+    }
+
+    // Indices of every object matching the predicate, in storage order. Each partition gets its own predicate and
+    // result buffer, the buffers are concatenated at the end.
+    template <typename Predicate, typename... Args>
+    std::vector<size_t> ParallelQueryObjects(Core::ThreadPool& pool, const Args&... args) const {
+        static_assert(std::is_base_of_v<ObjectPredicate, Predicate>, "Parallel queries must use an ObjectPredicate");
+        unsigned partitions = pool.GetPartitionCount(count);
+        std::vector<std::vector<size_t>> buffers(partitions);
+        pool.ParallelFor(count, partitions, [&](size_t begin, size_t end, unsigned partition) {
+            Predicate predicate(args...);
+            for (size_t i = begin; i < end; i++) {
+                if (predicate.Match(Get(i))) buffers[partition].push_back(i);
+            }
+        });
+
+        std::vector<size_t> result;
+        for (auto& buffer : buffers) {
+            result.insert(result.end(), buffer.begin(), buffer.end());
+        }
+        return result;
+    }
+
+    template <typename F> void Visit(F&& function) const {
+        size_t remaining = count;
+        for (auto& chunk : chunks) {
+            size_t n = remaining < ObjectChunk::CAPACITY ? remaining : ObjectChunk::CAPACITY;
+            for (size_t i = 0; i < n; i++) {
+                const Object& object = *chunk->objects[i];
+                Dispatch(object, function);
+            }
+            remaining -= n;
+        }
+    }
+};
+
+// Take shared ownership of a built object, the control block comes from a pool like the object itself
+inline std::shared_ptr<Object> ShareObject(std::unique_ptr<Object> object) {
+    return std::shared_ptr<Object>(object.release(), std::default_delete<Object>(), PoolAllocator<Object>());
+}
+
+} // namespace Cad
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cad/object/Object.h>
+
+#include <variant>
+
+namespace Cad {
+
+// Value representation of the closed set of object kinds. Packed into a vector it gives a contiguous copy of the
+// drawing that std::visit can walk without any virtual calls.
+using ObjectVariant = std::variant<LineObject, CircleObject, PolylineObject, InsertObject, HatchObject>;
+
+ObjectVariant ToVariant(const Object& object);
+std::unique_ptr<Object> FromVariant(const ObjectVariant& variant);
+
+// Resolve the concrete type from the object's tag and call the function with it. Unlike Accept() the call is
+// visible to the compiler, so a generic lambda is inlined and specialized once per object kind.
+template <typename F> decltype(auto) Dispatch(Object& object, F&& function) {
+    switch (object.GetType()) {
+    case ObjectType::Line: return function(static_cast<LineObject&>(object));
+    case ObjectType::Circle: return function(static_cast<CircleObject&>(object));
+    case ObjectType::Polyline: return function(static_cast<PolylineObject&>(object));
+    case ObjectType::Insert: return function(static_cast<InsertObject&>(object));
+    case ObjectType::Hatch: return function(static_cast<HatchObject&>(object));
+    }
+    return function(static_cast<LineObject&>(object));
+}
+
+template <typename F> decltype(auto) Dispatch(const Object& object, F&& function) {
+    switch (object.GetType()) {
+    case ObjectType::Line: return function(static_cast<const LineObject&>(object));
+    case ObjectType::Circle: return function(static_cast<const CircleObject&>(object));
+    case ObjectType::Polyline: return function(static_cast<const PolylineObject&>(object));
+    case ObjectType::Insert: return function(static_cast<const InsertObject&>(object));
+    case ObjectType::Hatch: return function(static_cast<const HatchObject&>(object));
+    }
+    return function(static_cast<const LineObject&>(object));
+}
+
+} // namespace Cad
@@ -9,6 +9,19 @@ struct ObjectVisitor {
     virtual void Visit(LineObject& line) = 0;
     virtual void Visit(CircleObject& circle) = 0;
     virtual void Visit(PolylineObject& polyline) = 0;
+    virtual void Visit(InsertObject& insert) = 0;
+    virtual void Visit(HatchObject& hatch) = 0;
+};
+
+// Read-only counterpart of ObjectVisitor, anything that only inspects the drawing (rendering, snapping, queries,
+// background work on snapshots) visits through this
+struct ConstObjectVisitor {
+    virtual ~ConstObjectVisitor() = default;
+    virtual void Visit(const LineObject& line) = 0;
+    virtual void Visit(const CircleObject& circle) = 0;
+    virtual void Visit(const PolylineObject& polyline) = 0;
+    virtual void Visit(const InsertObject& insert) = 0;
+    virtual void Visit(const HatchObject& hatch) = 0;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cad/object/ObjectRegistry.h>
+
+#include <vector>
+
+namespace Cad {
+
+// Objects picked by a closed outline, for lasso and fence selection. A window selection takes the objects entirely
+// inside the polygon, a crossing selection also the ones any part of whose outline is inside it or on its edge.
+// Candidates come from the layer indexes under the polygon's bounds. One point of every piece of their outline is
+// tested against the polygon in a single batch, and each piece is checked against the polygon edges near it, found
+// in a spatial index of the edges: a piece no edge meets lies wholly on the side its point is on.
+std::vector<ObjectRegistry::Reference> SelectInPolygon(
+    const ObjectRegistry& registry, const std::vector<Core::Vector2>& polygon, bool crossing, LayerFilter filter);
+
+// Twice the signed area of the polygon, positive when its vertices run counterclockwise with y pointing up
+float PolygonWinding(const std::vector<Core::Vector2>& polygon);
+
+} // namespace Cad
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cad/object/IdIndex.h>
+#include <cad/object/Layer.h>
+#include <cad/object/Object.h>
+#include <cad/object/ObjectMetrics.h>
+
+#include <array>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace Cad {
+
+// Composable description of the objects a registry query wants, built from terms and combined with &&, || and !:
+//
+//     Query::Selected() && Query::TypeIs(ObjectType::Circle) && Query::RadiusIn(5) && Query::Inside(window)
+//
+// Rect terms other than Crosses test object bounds. Queries are plain values, cheap to copy and combine; the registry compiles them
+// (see CompiledQuery) before running them.
+class Query {
+  public:
+    enum class Op {
+        True,
+        False,
+        Type,
+        Layer,
+        LayerFilter,
+        Selected,
+        Inside,
+        Intersects,
+        Crosses,
+        Length,
+        Radius,
+        And,
+        Or,
+        Not,
+    };
+
+    struct Node {
+        Op op;
+        ObjectType type = ObjectType::Line;
+        LayerId layer = 0;
+        Cad::LayerFilter filter = Cad::LayerFilter::All;
+        Core::Bounds rect = Core::Bounds();
+        float min = 0;
+        float max = 0;
+        std::shared_ptr<const Node> left = nullptr, right = nullptr;
+    };
+
+  private:
+    std::shared_ptr<const Node> root;
+
+    Query(Node node) : root(std::make_shared<const Node>(std::move(node))) {}
+
+  public:
+    static Query All() { return Query(Node{Op::True}); }
+    static Query TypeIs(ObjectType type);
+    static Query LayerIs(LayerId layer);
+    static Query OnLayers(LayerFilter filter);
+    static Query Selected() { return Query(Node{Op::Selected}); }
+    // Bounds entirely inside the rect
+    static Query Inside(const Core::Bounds& rect);
+    // Bounds touching the rect
+    static Query Intersects(const Core::Bounds& rect);
+    // Outline touching the rect, see ObjectCrosses
+    static Query Crosses(const Core::Bounds& rect);
+    // See ObjectLength
+    static Query LengthIn(float min, float max = std::numeric_limits<float>::infinity());
+    // Circles only
+    static Query RadiusIn(float min, float max = std::numeric_limits<float>::infinity());
+
+    Query operator&&(const Query& other) const;
+    Query operator||(const Query& other) const;
+    Query operator!() const;
+
+    const Node& GetRoot() const { return *root; }
+};
+
+// A query specialized for each object type. Terms that are decided by the type alone are folded away, so a kind
+// the query rules out is rejected on its tag and the rest run a short flat program with the concrete type known.
+// The compiled query also works out a rect and a set of layers every match must lie in, if the query implies them,
+// which lets the registry search only the spatial indexes of those layers.
+class CompiledQuery {
+    static constexpr size_t TYPE_COUNT = 5;
+
+    struct Instruction {
+        Query::Op op;
+        LayerId layer = 0;
+        Core::Bounds rect = Core::Bounds();
+        float min = 0, max = 0;
+    };
+
+    struct Program {
+        // Decided by the type alone, no instructions to run
+        std::optional<bool> constant;
+        // Postfix, And/Or/Not pop their operands off the evaluation stack
+        std::vector<Instruction> code;
+        // Deepest the evaluation stack gets
+        size_t depth = 0;
+    };
+
+    std::array<Program, TYPE_COUNT> programs;
+    std::optional<Core::Bounds> rect;
+    std::optional<std::vector<bool>> layers;
+    // Per layer results of the LayerFilter terms, indexed by the filter
+    std::array<std::vector<bool>, 3> accepted;
+    // The registry's selection, for the Selected terms
+    const IdIndex<size_t>& selection;
+
+    Program Fold(const Query::Node& node, ObjectType type) const;
+
+    template <typename T> bool Run(const Program& program, const T& object) const;
+
+  public:
+    // Selected terms read the selection as it is when the query runs, not as it was when compiled
+    CompiledQuery(const Query& query, const std::vector<Layer>& layers, const IdIndex<size_t>& selection);
+
+    // Every match lies inside this rect, if there is one
+    const std::optional<Core::Bounds>& GetRect() const { return rect; }
+    // False for layers no match can be on
+    bool MayMatch(LayerId layer) const { return !layers || (*layers)[layer]; }
+    // False if nothing at all can match
+    bool MayMatch() const;
+
+    bool Matches(const Object& object) const;
+};
+
+template <typename T> bool CompiledQuery::Run(const Program& program, const T& object) const {
+    if (program.constant) return *program.constant;
+
+    // Programs are short, a fixed stack saves an allocation per object
+    constexpr size_t STACK_SIZE = 32;
+    bool local[STACK_SIZE] = {};
+    std::unique_ptr<bool[]> heap;
+    bool* stack = local;
+    if (program.depth > STACK_SIZE) {
+        heap = std::make_unique<bool[]>(program.depth);
+        stack = heap.get();
+    }
+    size_t top = 0;
+    for (const Instruction& instruction : program.code) {
+        switch (instruction.op) {
+        case Query::Op::Layer: stack[top++] = object.GetLayer() == instruction.layer; break;
+        case Query::Op::LayerFilter: stack[top++] = accepted[instruction.layer][object.GetLayer()]; break;
+        case Query::Op::Selected: stack[top++] = selection.Find(object.GetId()) != nullptr; break;
+        case Query::Op::Inside: stack[top++] = instruction.rect.Contains(object.T::GetBounds()); break;
+        case Query::Op::Intersects: stack[top++] = instruction.rect.Intersects(object.T::GetBounds()); break;
+        case Query::Op::Crosses: stack[top++] = ObjectCrosses(object, instruction.rect); break;
+        case Query::Op::Length: {
+            float length = ObjectLength(object);
+            stack[top++] = length >= instruction.min && length <= instruction.max;
+            break;
+        }
+        case Query::Op::Radius:
+            if constexpr (std::is_same_v<T, CircleObject>) {
+                stack[top++] = object.radius >= instruction.min && object.radius <= instruction.max;
+            } else {
+                stack[top++] = false;
+            }
+            break;
+        case Query::Op::And: top--; stack[top - 1] = stack[top - 1] && stack[top]; break;
+        case Query::Op::Or: top--; stack[top - 1] = stack[top - 1] || stack[top]; break;
+        case Query::Op::Not: stack[top - 1] = !stack[top - 1]; break;
+        default: break;
+        }
+    }
+    return stack[0];
+}
+
+} // namespace Cad
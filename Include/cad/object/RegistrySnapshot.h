@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cad/object/Layer.h>
+#include <cad/object/ObjectTable.h>
+
+#include <cstdint>
+
+namespace Cad {
+
+// Immutable view of the registry as of the moment it was taken. Taking one is O(1), it shares the registry's chunks
+// and objects, and later edits to the registry copy whatever they touch instead of changing what the snapshot sees.
+// Snapshots can be handed to worker threads and read there while the editor keeps changing the registry.
+class RegistrySnapshot {
+    friend class ObjectRegistry;
+
+    std::shared_ptr<const ObjectTable> table;
+    std::shared_ptr<const std::vector<Layer>> layers;
+    uint64_t revision = 0;
+
+    RegistrySnapshot(
+        std::shared_ptr<const ObjectTable> table, std::shared_ptr<const std::vector<Layer>> layers, uint64_t revision)
+        : table(std::move(table)), layers(std::move(layers)), revision(revision) {}
+
+  public:
+    RegistrySnapshot()
+        : table(std::make_shared<ObjectTable>()), layers(std::make_shared<std::vector<Layer>>(1, Layer("0"))) {}
+
+    uint64_t GetRevision() const { return revision; }
+    unsigned int Count() const { return table->count; }
+
+    const Object& GetObject(unsigned int index) const { return table->Get(index); }
+    const Layer& GetLayer(LayerId layer) const { return (*layers)[layer]; }
+    unsigned int LayerCount() const { return layers->size(); }
+
+    void VisitObjects(ConstObjectVisitor& visitor) const { table->VisitObjects(visitor); }
+    template <typename F> void Visit(F&& function) const { table->Visit(function); }
+
+    // See ObjectTable::ParallelVisitObjects
+    template <typename Visitor, typename... Args> std::vector<Visitor> ParallelVisitObjects(const Args&... args) const {
+        return table->ParallelVisitObjects<Visitor>(Core::ThreadPool::Shared(), args...);
+    }
+};
+
+} // namespace Cad
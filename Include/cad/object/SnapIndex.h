@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cad/object/IdIndex.h>
+#include <cad/object/ObjectRegistry.h>
+
+#include <functional>
+#include <vector>
+
+namespace Cad {
+
+// World space KD-tree over the points the cursor can snap to, so that finding the snaps near the mouse is a nearest
+// neighbour search instead of a pass over every object on screen. Like the EndpointGraph it is brought up to date
+// from the registry's journal on Sync. A balanced tree is rebuilt only every so often: points of objects added since
+// then are kept in a short list that is searched linearly, and points of removed objects are left in the tree and
+// skipped until the next rebuild.
+class SnapIndex {
+  public:
+    enum class Kind {
+        Endpoint,
+        Midpoint,
+        Center,
+        Quadrant,
+    };
+
+    struct Candidate {
+        Core::Vector2 point;
+        Kind kind;
+        ObjectId owner;
+    };
+
+  private:
+    // Candidates of removed objects have a NULL_ID owner
+    std::vector<Candidate> candidates;
+    // The first `built` candidates, ordered as an implicit tree: the median of every range splits it, on x at even
+    // depths and on y at odd ones
+    std::vector<uint32_t> tree;
+    size_t built = 0;
+    size_t removed = 0;
+    // Slots of the candidates each object contributed
+    IdIndex<std::vector<uint32_t>> by_object;
+
+    ObjectRegistry::Journal::Cursor cursor = 0;
+    bool synced = false;
+
+    void Add(const Object& object);
+    void Remove(ObjectId id);
+    void Rebuild(const ObjectRegistry& registry);
+    // Drop the removed candidates and build the tree over the rest
+    void Build();
+
+  public:
+    SnapIndex() = default;
+
+    // Apply the registry's changes since the last sync, or rebuild if the journal no longer has them
+    void Sync(const ObjectRegistry& registry);
+
+    // Up to k candidates within the radius of the point that the filter accepts, closest first. Visits O(log n) nodes
+    // for a small radius.
+    std::vector<Candidate> Nearest(Core::Vector2 point, float radius, size_t k,
+        const std::function<bool(const Candidate&)>& accept = nullptr) const;
+
+    size_t Count() const { return candidates.size() - removed; }
+
+    // Append the snap points of the object
+    static void Collect(const Object& object, std::vector<Candidate>& candidates);
+};
+
+} // namespace Cad
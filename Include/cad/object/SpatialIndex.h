@@ -0,0 +1,297 @@
+#pragma once
+
+#include <core/math/Bounds.h>
+#include <core/math/Geometry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+namespace Cad {
+
+// Hierarchical grid of bounding boxes. Every item lives on the level whose cells are at least as large as the item,
+// so it is stored in at most 2x2 cells no matter how big it is, and a rect query only looks at the cells it overlaps
+// on each level (or at the occupied cells, when that is fewer). Values must be equality comparable so that they can
+// be found again on removal, and removal must be given the same bounds the value was inserted with.
+template <typename T> class SpatialIndex {
+    struct Item {
+        T value;
+        Core::Bounds bounds;
+    };
+
+    struct CellRange {
+        int64_t x0, y0, x1, y1;
+        double Area() const { return double(x1 - x0 + 1) * double(y1 - y0 + 1); }
+    };
+
+    struct Level {
+        float cell_size;
+        std::unordered_map<uint64_t, std::vector<Item>> cells;
+        size_t count = 0;
+    };
+
+    static constexpr int LEVEL_COUNT = 24;
+
+    std::vector<Level> levels;
+    size_t count = 0;
+
+    static uint64_t Key(int64_t x, int64_t y) { return (uint64_t(uint32_t(int32_t(x))) << 32) | uint32_t(int32_t(y)); }
+    static int64_t KeyX(uint64_t key) { return int32_t(uint32_t(key >> 32)); }
+    static int64_t KeyY(uint64_t key) { return int32_t(uint32_t(key)); }
+
+    static int64_t CellOf(float coordinate, float cell_size) {
+        float cell = std::floor(coordinate / cell_size);
+        if (!(cell > -2e9f)) return -2000000000;
+        if (!(cell < 2e9f)) return 2000000000;
+        return int64_t(cell);
+    }
+
+    static CellRange RangeOf(const Core::Bounds& bounds, float cell_size) {
+        return CellRange{CellOf(bounds.min.x, cell_size), CellOf(bounds.min.y, cell_size),
+            CellOf(bounds.max.x, cell_size), CellOf(bounds.max.y, cell_size)};
+    }
+
+    int LevelOf(const Core::Bounds& bounds) const {
+        float extent = std::max(bounds.max.x - bounds.min.x, bounds.max.y - bounds.min.y);
+        int level = 0;
+        while (level < LEVEL_COUNT - 1 && levels[level].cell_size < extent) {
+            level++;
+        }
+        return level;
+    }
+
+    // Report an item only from the first cell that both it and the query cover, so items stored in several cells are
+    // handed out once without needing a visited set (which would make concurrent queries unsafe)
+    template <typename F>
+    static void QueryCell(const std::vector<Item>& items, int64_t x, int64_t y, const CellRange& query,
+        const Core::Bounds& rect, float cell_size, F& function) {
+        for (const Item& item : items) {
+            if (!item.bounds.Intersects(rect)) continue;
+            CellRange range = RangeOf(item.bounds, cell_size);
+            if (x != std::max(range.x0, query.x0) || y != std::max(range.y0, query.y0)) continue;
+            function(item.value, item.bounds);
+        }
+    }
+
+    static Core::Bounds CellBounds(int64_t x, int64_t y, float cell_size) {
+        return Core::Bounds(Core::Vector2(float(x) * cell_size, float(y) * cell_size),
+            Core::Vector2(float(x + 1) * cell_size, float(y + 1) * cell_size));
+    }
+
+    // Where the segment enters the part of the item's bounds inside the cell
+    static bool EntersAt(Core::Vector2 a, Core::Vector2 d, const Core::Bounds& bounds, int64_t x, int64_t y,
+        float cell_size, double& t) {
+        Core::Bounds cell = CellBounds(x, y, cell_size);
+        Core::Bounds part(Core::Vector2(std::max(bounds.min.x, cell.min.x), std::max(bounds.min.y, cell.min.y)),
+            Core::Vector2(std::min(bounds.max.x, cell.max.x), std::min(bounds.max.y, cell.max.y)));
+        double t1 = 1;
+        t = 0;
+        return Core::ClipLine(a, d, part, t, t1);
+    }
+
+    // Segment version of QueryCell: the item is reported from the cell where the segment enters its bounds first
+    template <typename F>
+    static void QueryLineCell(const std::vector<Item>& items, int64_t x, int64_t y, Core::Vector2 a, Core::Vector2 d,
+        float cell_size, F& function) {
+        for (const Item& item : items) {
+            double t;
+            if (!EntersAt(a, d, item.bounds, x, y, cell_size, t)) continue;
+            CellRange range = RangeOf(item.bounds, cell_size);
+            bool first = true;
+            for (int64_t cx = range.x0; cx <= range.x1 && first; cx++) {
+                for (int64_t cy = range.y0; cy <= range.y1 && first; cy++) {
+                    if (cx == x && cy == y) continue;
+                    double other;
+                    if (!EntersAt(a, d, item.bounds, cx, cy, cell_size, other)) continue;
+                    first = !(other < t || (other == t && (cx < x || (cx == x && cy < y))));
+                }
+            }
+            if (first) function(item.value, item.bounds);
+        }
+    }
+
+  public:
+    SpatialIndex(float base_cell_size = 1.0f) {
+        float cell_size = base_cell_size;
+        for (int i = 0; i < LEVEL_COUNT; i++) {
+            levels.push_back(Level{cell_size, {}, 0});
+            cell_size *= 2;
+        }
+    }
+
+    void Insert(const T& value, const Core::Bounds& bounds) {
+        if (bounds.IsEmpty()) return;
+        Level& level = levels[LevelOf(bounds)];
+        CellRange range = RangeOf(bounds, level.cell_size);
+        for (int64_t x = range.x0; x <= range.x1; x++) {
+            for (int64_t y = range.y0; y <= range.y1; y++) {
+                level.cells[Key(x, y)].push_back(Item{value, bounds});
+            }
+        }
+        level.count++;
+        count++;
+    }
+
+    bool Remove(const T& value, const Core::Bounds& bounds) {
+        if (bounds.IsEmpty()) return false;
+        Level& level = levels[LevelOf(bounds)];
+        CellRange range = RangeOf(bounds, level.cell_size);
+        bool removed = false;
+        for (int64_t x = range.x0; x <= range.x1; x++) {
+            for (int64_t y = range.y0; y <= range.y1; y++) {
+                auto cell = level.cells.find(Key(x, y));
+                if (cell == level.cells.end()) continue;
+                auto& items = cell->second;
+                for (size_t i = 0; i < items.size(); i++) {
+                    if (!(items[i].value == value)) continue;
+                    items[i] = std::move(items.back());
+                    items.pop_back();
+                    removed = true;
+                    break;
+                }
+                if (items.empty()) level.cells.erase(cell);
+            }
+        }
+        if (removed) {
+            level.count--;
+            count--;
+        }
+        return removed;
+    }
+
+    void Update(const T& value, const Core::Bounds& old_bounds, const Core::Bounds& new_bounds) {
+        if (old_bounds == new_bounds) return;
+        Remove(value, old_bounds);
+        Insert(value, new_bounds);
+    }
+
+    // Remove every item whose value the predicate picks, in one pass over the occupied cells. Cheaper than removing
+    // them one at a time once they are a good share of the index.
+    template <typename P> void RemoveIf(P&& predicate) {
+        for (Level& level : levels) {
+            if (level.count == 0) continue;
+            for (auto cell = level.cells.begin(); cell != level.cells.end();) {
+                auto& items = cell->second;
+                for (size_t i = 0; i < items.size();) {
+                    if (!predicate(items[i].value)) {
+                        i++;
+                        continue;
+                    }
+                    // Counted once, from the first cell the item is in
+                    CellRange range = RangeOf(items[i].bounds, level.cell_size);
+                    if (KeyX(cell->first) == range.x0 && KeyY(cell->first) == range.y0) {
+                        level.count--;
+                        count--;
+                    }
+                    items[i] = std::move(items.back());
+                    items.pop_back();
+                }
+                cell = items.empty() ? level.cells.erase(cell) : std::next(cell);
+            }
+        }
+    }
+
+    // Call the function with (value, bounds) for every item whose bounds intersect the rect, each exactly once
+    template <typename F> void Query(const Core::Bounds& rect, F&& function) const {
+        if (rect.IsEmpty()) return;
+        for (const Level& level : levels) {
+            if (level.count == 0) continue;
+            CellRange query = RangeOf(rect, level.cell_size);
+            if (query.Area() <= double(level.cells.size())) {
+                for (int64_t x = query.x0; x <= query.x1; x++) {
+                    for (int64_t y = query.y0; y <= query.y1; y++) {
+                        auto cell = level.cells.find(Key(x, y));
+                        if (cell == level.cells.end()) continue;
+                        QueryCell(cell->second, x, y, query, rect, level.cell_size, function);
+                    }
+                }
+            } else {
+                for (auto& [key, items] : level.cells) {
+                    int64_t x = KeyX(key);
+                    int64_t y = KeyY(key);
+                    if (x < query.x0 || x > query.x1 || y < query.y0 || y > query.y1) continue;
+                    QueryCell(items, x, y, query, rect, level.cell_size, function);
+                }
+            }
+        }
+    }
+
+    // Call the function with (value, bounds) for every item whose bounds the segment from a to b passes through, each
+    // exactly once. Looks at the cells along the segment on each level (or at the occupied cells, when that is fewer),
+    // so a long thin query costs its length rather than the area of its bounding rect.
+    template <typename F> void QueryLine(Core::Vector2 a, Core::Vector2 b, F&& function) const {
+        Core::Vector2 d = b - a;
+        Core::Bounds rect = Core::Bounds::FromPoints(a, b);
+        for (const Level& level : levels) {
+            if (level.count == 0) continue;
+            float cell_size = level.cell_size;
+            // One cell of margin, a segment running along a cell edge may be reported from the cell on either side
+            CellRange span = RangeOf(rect, cell_size);
+            span = CellRange{span.x0 - 1, span.y0 - 1, span.x1 + 1, span.y1 + 1};
+            double walk = double(span.x1 - span.x0 + 1) + double(span.y1 - span.y0 + 1);
+            if (walk <= double(level.cells.size())) {
+                // The rows the segment covers in each column, with some slack so rounding never drops a cell
+                float slack = cell_size * 1e-3f;
+                for (int64_t x = span.x0; x <= span.x1; x++) {
+                    float low = rect.min.y, high = rect.max.y;
+                    if (d.x != 0) {
+                        float left = std::max(rect.min.x, float(x) * cell_size);
+                        float right = std::min(rect.max.x, float(x + 1) * cell_size);
+                        float y_left = a.y + (left - a.x) * d.y / d.x, y_right = a.y + (right - a.x) * d.y / d.x;
+                        low = std::min(y_left, y_right);
+                        high = std::max(y_left, y_right);
+                    }
+                    int64_t y0 = std::max(span.y0, CellOf(low - slack, cell_size));
+                    int64_t y1 = std::min(span.y1, CellOf(high + slack, cell_size));
+                    for (int64_t y = y0; y <= y1; y++) {
+                        auto cell = level.cells.find(Key(x, y));
+                        if (cell == level.cells.end()) continue;
+                        QueryLineCell(cell->second, x, y, a, d, cell_size, function);
+                    }
+                }
+            } else {
+                for (auto& [key, items] : level.cells) {
+                    int64_t x = KeyX(key);
+                    int64_t y = KeyY(key);
+                    if (x < span.x0 || x > span.x1 || y < span.y0 || y > span.y1) continue;
+                    QueryLineCell(items, x, y, a, d, cell_size, function);
+                }
+            }
+        }
+    }
+
+    // Call the function with (value, bounds) for every item, each exactly once
+    template <typename F> void ForEach(F&& function) const {
+        for (const Level& level : levels) {
+            for (auto& [key, items] : level.cells) {
+                for (const Item& item : items) {
+                    CellRange range = RangeOf(item.bounds, level.cell_size);
+                    if (KeyX(key) != range.x0 || KeyY(key) != range.y0) continue;
+                    function(item.value, item.bounds);
+                }
+            }
+        }
+    }
+
+    // Union of every item's bounds
+    Core::Bounds GetBounds() const {
+        Core::Bounds bounds;
+        ForEach([&bounds](const T&, const Core::Bounds& item_bounds) { bounds.Expand(item_bounds); });
+        return bounds;
+    }
+
+    void Clear() {
+        for (Level& level : levels) {
+            level.cells.clear();
+            level.count = 0;
+        }
+        count = 0;
+    }
+
+    size_t Count() const { return count; }
+};
+
+} // namespace Cad
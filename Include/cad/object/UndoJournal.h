@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cad/object/IdIndex.h>
+#include <cad/object/Object.h>
+#include <core/math/Matrix3.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Cad {
+
+// Undo and redo history of the registry's objects. An entry lists the changes one edit made as deltas rather than
+// copies of the drawing: the IDs of the objects it created, the objects it deleted, the matrix it transformed objects
+// by and the version an object had before any other kind of change. Undo and redo hand those same objects back and
+// forth with the drawing, so neither costs more than the edit did. Once the history outgrows its memory budget the
+// oldest entries are dropped.
+//
+// The registry records into the entry of the outermost open group. Changes made by one group are one entry, and a
+// group can amend the entry before it, so a drag that moves objects a little every frame is undone in one step.
+class UndoJournal {
+  public:
+    struct Change {
+        enum class Kind {
+            // The objects are in the drawing after the change. The held objects are filled in when it is undone.
+            Created,
+            // The objects are out of the drawing after the change and held here until it is undone
+            Deleted,
+            // The objects were moved by the matrix
+            Transformed,
+            // Each held object is the other version of the object with its ID, undo and redo swap the two
+            Modified,
+        };
+
+        Kind kind;
+        std::vector<ObjectId> ids;
+        // Parallel to the IDs while held, null where an object was already gone
+        std::vector<std::shared_ptr<Object>> objects;
+        Core::Matrix3 matrix;
+    };
+
+    struct Entry {
+        std::string label;
+        std::vector<Change> changes;
+        size_t bytes = 0;
+    };
+
+  private:
+    std::deque<Entry> undo;
+    std::deque<Entry> redo;
+    // Entry of the open group, and the IDs the last change in it already holds an earlier version of
+    Entry pending;
+    IdIndex<bool> held;
+    int depth = 0;
+    bool suspended = false;
+    size_t budget;
+    size_t used = 0;
+
+    // Continue the last change of the pending entry if it is of the same kind, otherwise start a new one
+    Change& Extend(Change::Kind kind);
+    void Push(std::deque<Entry>& stack, Entry entry);
+    // Drop the oldest entries until the history fits its budget, the latest entry to undo is always kept
+    void Trim();
+
+  public:
+    UndoJournal(size_t budget = 64 << 20) : budget(budget) {}
+
+    // Group the changes until the matching End into one entry, only the outermost group counts. Amending reopens the
+    // latest entry to undo if it has the same label, to merge the steps of a drag.
+    void Begin(std::string label, bool amend = false);
+    void End();
+
+    // While suspended nothing is recorded, the registry suspends the journal to undo and redo
+    void Suspend(bool suspend) { suspended = suspend; }
+    bool IsRecording() const { return depth > 0 && !suspended; }
+    // True while a group is open and has recorded something
+    bool IsPending() const { return !pending.changes.empty(); }
+
+    void RecordCreated(ObjectId id);
+    void RecordDeleted(ObjectId id, std::shared_ptr<Object> object);
+    // Back to back transforms of the same objects are recorded as one
+    void RecordTransformed(std::vector<ObjectId> ids, const Core::Matrix3& matrix);
+    // Only the first version of an object is kept while it is changed over and over, swapping that one back is
+    // enough to undo all of it
+    void RecordModified(ObjectId id, std::shared_ptr<Object> before);
+
+    // Take the entry to undo or redo, the registry applies it and puts it on the other stack
+    bool PopUndo(Entry& entry);
+    bool PopRedo(Entry& entry);
+    void PushUndo(Entry entry) { Push(undo, std::move(entry)); }
+    void PushRedo(Entry entry) { Push(redo, std::move(entry)); }
+
+    size_t UndoCount() const { return undo.size(); }
+    size_t RedoCount() const { return redo.size(); }
+    const std::string& NextUndo() const { return undo.back().label; }
+    const std::string& NextRedo() const { return redo.back().label; }
+
+    void SetBudget(size_t bytes);
+    size_t GetBudget() const { return budget; }
+    // Estimated memory held by the history
+    size_t GetUsed() const { return used; }
+    void Clear();
+
+    static size_t EstimateBytes(const Entry& entry);
+};
+
+} // namespace Cad
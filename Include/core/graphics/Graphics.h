@@ -2,10 +2,12 @@
 
 #include <core/graphics/Pixel.h>
 #include <core/graphics/Image.h>
+#include <core/math/Geometry.h>
 #include <core/math/Transform.h>
 #include <core/math/Vector2.h>
 
 #include <stack>
+#include <vector>
 
 namespace Core {
 struct Image;
@@ -26,6 +28,8 @@ class Graphics {
     void SetTransformed(bool is_transformed);
     void PushTransform(const Transform& transform);
     void PopTransform();
+    // The transform drawing currently goes through, identity if none has been pushed
+    Transform GetTransform() const;
 
     bool HasClip();
     void PushClip(float x, float y, float w, float h);
@@ -43,8 +47,15 @@ class Graphics {
     virtual void DrawTriangle(Pixel color, float x0, float y0, float x1, float y1, float x2, float y2) = 0;
     virtual void DrawArc(Pixel color, float x, float y, float radius, float start_angle, float end_angle) = 0;
     virtual void DrawImage(Image& image, float x, float y, float width, float height) = 0;
+    // Copy the image pixel for pixel with its top left corner at the screen position, skipping transparent pixels.
+    // The transform is ignored and only the part that lands on screen is touched.
+    virtual void BlitImage(Image& image, int x, int y) = 0;
     virtual void FillRect(Pixel color, unsigned x, unsigned y, unsigned width, unsigned height) = 0;
     virtual void FillCircle(Pixel color, unsigned x, unsigned y, unsigned radius) = 0;
     virtual void FillTriangle(Pixel color, float x0, float y0, float x1, float y1, float x2, float y2) = 0;
+    // Fill the region enclosed by the closed contours, see ScanPolygon. Several contours make holes or islands in
+    // each other, which the rule decides.
+    virtual void FillPolygon(
+        Pixel color, const std::vector<std::vector<Vector2>>& contours, FillRule rule = FillRule::EvenOdd) = 0;
 };
 } // namespace Core
\ No newline at end of file
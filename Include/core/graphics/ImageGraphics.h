@@ -33,8 +33,10 @@ class ImageGraphics : public Graphics {
     }
     void DrawArc(Pixel color, float x, float y, float radius, float start_angle, float end_angle) override;
     void DrawImage(Image& image, float x, float y, float width, float height) override;
+    void BlitImage(Image& image, int x, int y) override;
     void FillRect(Pixel color, unsigned x, unsigned y, unsigned width, unsigned height) override;
     void FillCircle(Pixel color, unsigned x, unsigned y, unsigned radius) override;
     void FillTriangle(Pixel color, float x0, float y0, float x1, float y1, float x2, float y2) override;
+    void FillPolygon(Pixel color, const std::vector<std::vector<Vector2>>& contours, FillRule rule) override;
 };
 } // namespace Core
\ No newline at end of file
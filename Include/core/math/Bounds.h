@@ -0,0 +1,34 @@
+#pragma once
+
+#include <core/math/Vector2.h>
+
+namespace Core {
+
+// Axis aligned bounding box, an empty box has min > max and contains nothing
+struct Bounds {
+    Vector2 min, max;
+
+    Bounds();
+    Bounds(Vector2 min, Vector2 max);
+
+    static Bounds FromPoints(Vector2 a, Vector2 b);
+
+    bool IsEmpty() const { return min.x > max.x || min.y > max.y; }
+    Vector2 GetSize() const { return max - min; }
+    Vector2 GetCenter() const { return (min + max) / 2; }
+
+    Bounds& Expand(Vector2 point);
+    Bounds& Expand(const Bounds& other);
+    Bounds Inflated(float amount) const;
+    // Overlap of the two boxes, empty if they don't intersect
+    Bounds Intersected(const Bounds& other) const;
+
+    bool Contains(Vector2 point) const;
+    bool Contains(const Bounds& other) const;
+    bool Intersects(const Bounds& other) const;
+
+    bool operator==(const Bounds& other) const { return min == other.min && max == other.max; }
+    bool operator!=(const Bounds& other) const { return !(*this == other); }
+};
+
+} // namespace Core
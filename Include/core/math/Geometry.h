@@ -0,0 +1,78 @@
+#pragma once
+
+#include <core/math/Bounds.h>
+#include <core/math/Matrix3.h>
+#include <core/math/Vector2.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Core {
+
+// Up to two intersection points. Everything below is computed in double and only rounded to float at the end, so
+// points from nearly parallel segments or nearly tangent circles keep their precision.
+struct Intersections {
+    int count = 0;
+    Vector2 points[2];
+
+    void Add(Vector2 point) { points[count++] = point; }
+};
+
+// Segments that touch at an end intersect. Collinear overlapping segments have no single point and report none.
+Intersections IntersectSegments(Vector2 a0, Vector2 a1, Vector2 b0, Vector2 b1);
+
+// Points where the segment crosses or touches the circle's outline
+Intersections IntersectSegmentCircle(Vector2 a0, Vector2 a1, Vector2 center, float radius);
+
+// Points where two circle outlines meet, none for concentric circles
+Intersections IntersectCircles(Vector2 center0, float radius0, Vector2 center1, float radius1);
+
+// The same for the infinite line through the origin along the direction, which need not be normalized. Parallel lines
+// report nothing, as do collinear ones.
+Intersections IntersectLineSegment(Vector2 origin, Vector2 direction, Vector2 a0, Vector2 a1);
+Intersections IntersectLineCircle(Vector2 origin, Vector2 direction, Vector2 center, float radius);
+Intersections IntersectLines(Vector2 origin0, Vector2 direction0, Vector2 origin1, Vector2 direction1);
+
+// Distance from the point to the closest point of the segment
+float DistanceToSegment(Vector2 point, Vector2 a, Vector2 b);
+
+// Narrow [t0, t1] to the part of origin + t * direction inside the box, false if none of it is. Pass infinite limits
+// for a whole line and 0 and 1 for a segment from origin to origin + direction.
+bool ClipLine(Vector2 origin, Vector2 direction, const Bounds& box, double& t0, double& t1);
+
+// Points stored as separate x and y arrays, for kernels that test many points at once
+struct PointBatch {
+    std::vector<float> x, y;
+
+    void Add(Vector2 point) {
+        x.push_back(point.x);
+        y.push_back(point.y);
+    }
+    size_t Size() const { return x.size(); }
+};
+
+// Even-odd test of every point in the batch against the closed polygon, the last vertex joins the first. Sets a
+// nonzero entry in `inside` for the points inside. The points are sorted into horizontal bands and each edge runs a
+// branch free loop over the bands it spans, which the compiler vectorizes at -O3 (the Release build).
+void PointsInPolygon(const PointBatch& points, const std::vector<Vector2>& polygon, std::vector<uint32_t>& inside);
+
+// Which points a set of closed contours encloses: those a ray from the point crosses the contours an odd number of
+// times on, or for NonZero those the contours wind around more often one way than the other
+enum class FillRule {
+    EvenOdd,
+    NonZero,
+};
+
+// Sweep the horizontal lines y = first + k * step for k in [0, count) through the region the contours enclose, the
+// last vertex of each contour joining its first. An edge table sorted by the first line each edge reaches feeds an
+// active list that holds only the edges the current line crosses, ordered by x. span(y, x0, x1) is called for every
+// stretch of a line inside the region, left to right. Edges cover [low y, high y), so a line through a vertex counts
+// the two edges meeting there once.
+void ScanPolygon(const std::vector<std::vector<Vector2>>& contours, FillRule rule, float first, float step, int count,
+    const std::function<void(float y, float x0, float x1)>& span);
+
+// Apply the affine matrix to every point in the batch, in a loop the compiler vectorizes at -O3
+void TransformPoints(const Matrix3& matrix, PointBatch& points);
+
+} // namespace Core
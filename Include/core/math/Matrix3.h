@@ -16,6 +16,16 @@ struct Matrix3 {
     static Matrix3 Translation(float x, float y);
     static Matrix3 Rotation(float angle);
     static Matrix3 Scale(float x, float y);
+    // Mirror across the line through the point along the direction
+    static Matrix3 Reflection(Vector2 point, Vector2 direction);
+    // Rotation and scale about a point rather than the origin
+    static Matrix3 Rotation(Vector2 point, float angle);
+    static Matrix3 Scale(Vector2 point, float scale);
+
+    // Determinant of the linear part, negative for a mirror
+    float Determinant() const;
+    // Inverse of an affine matrix, the bottom row is taken to be 0 0 1
+    Matrix3 Inverse() const;
 };
-    
-} // namespace Core
\ No newline at end of file
+
+} // namespace Core
@@ -18,6 +18,14 @@ struct Transform {
     Vector2 Apply(Vector2 point) const;
     Transform Inverse() const;
 
+    // Composition, (outer * inner).Apply(p) == outer.Apply(inner.Apply(p))
+    Transform operator*(const Transform& inner) const;
+
+    bool operator==(const Transform& other) const {
+        return x == other.x && y == other.y && scale == other.scale && rotation == other.rotation;
+    }
+    bool operator!=(const Transform& other) const { return !(*this == other); }
+
     float GetX() const { return x; }
     float GetY() const { return y; }
     float GetScale() const { return scale; }
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Core {
+
+// Fixed set of worker threads for splitting data parallel passes. Work is submitted as contiguous ranges and the
+// caller blocks until every range has been processed, taking one of the ranges itself.
+class ThreadPool {
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_available;
+    bool stopping = false;
+
+    void Work();
+
+  public:
+    using RangeFunction = std::function<void(size_t begin, size_t end, unsigned partition)>;
+
+    ThreadPool(unsigned thread_count = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Workers plus the calling thread
+    unsigned GetConcurrency() const { return workers.size() + 1; }
+
+    // How many ranges to cut count items into, small inputs are not worth waking the workers for
+    unsigned GetPartitionCount(size_t count, size_t grain = 4096) const;
+
+    // Split [0, count) into the given number of contiguous ranges and run the function on each. Must not be called
+    // from inside a range function, a worker waiting on nested work could starve the pool.
+    void ParallelFor(size_t count, unsigned partitions, const RangeFunction& function);
+
+    static ThreadPool& Shared();
+};
+
+} // namespace Core
@@ -1,7 +1,13 @@
 #include <cad/Application.h>
+#include <cad/SelectionPreview.h>
 #include <cad/gui/Gui.h>
+#include <cad/object/Block.h>
 #include <cad/object/ObjectVisitor.h>
+#include <cad/object/PolygonSelection.h>
 #include <core/graphics/ImageGraphics.h>
+
+#include <map>
+
 namespace Cad {
 
 struct CreateCircleHandler : public InputHandler {
@@ -53,47 +59,13 @@ struct CreateCircleHandler : public InputHandler {
     }
 };
 
-struct DeselectAllVisitor : ObjectVisitor {
-    DeselectAllVisitor() = default;
-
-    void Visit(LineObject& object) override { object.Deselect(); }
-
-    void Visit(CircleObject& object) override { object.Deselect(); }
-
-    void Visit(PolylineObject& object) override { object.Deselect(); }
-};
-
-struct SelectionVisitor : public ObjectVisitor {
-    Core::Vector2 topleft;
-    float width;
-    float height;
-
-    SelectionVisitor(Core::Vector2 topleft, float width, float height)
-        : topleft(topleft), width(width), height(height) {}
-
-    void Visit(LineObject& object) override {
-        auto& start = object.start;
-        auto& end = object.end;
-        if (start.x > topleft.x && start.x < topleft.x + width && start.y > topleft.y && start.y < topleft.y + height) {
-            object.Select();
-        }
-        if (end.x > topleft.x && end.x < topleft.x + width && end.y > topleft.y && end.y < topleft.y + height) {
-            object.Select();
-        }
-    }
-
-    void Visit(CircleObject& object) override {
-        // Check to see if the circle is within the selection box
-        auto& center = object.center;
-        float radius = object.radius;
-        if (center.x - radius > topleft.x && center.x + radius < topleft.x + width && center.y - radius > topleft.y &&
-            center.y + radius < topleft.y + height) {
-            object.Select();
-        }
-    }
+// Object whose outline passes within a few pixels of the mouse
+static ObjectRegistry::Reference PickUnderMouse(Cad::Controller& controller, LayerFilter filter) {
+    auto transform = controller.GetViewfinder().GetViewTransform();
+    auto mouse_world = transform.Inverse().Apply(controller.GetInput().GetMousePosition());
+    return controller.GetRegistry().Pick(mouse_world, 5 / transform.scale, filter);
+}
 
-    void Visit(PolylineObject& object) override {}
-};
 struct SelectionModeHandler : public InputHandler {
     std::stack<Core::Vector2> points;
 
@@ -104,14 +76,18 @@ struct SelectionModeHandler : public InputHandler {
 
         if (input.IsPressed(Core::Key::Space)) {
             // Deselect all objects
-            auto& registry = controller.GetRegistry();
-            DeselectAllVisitor visitor;
-            registry.VisitObjects(visitor);
+            controller.GetRegistry().DeselectAll();
         }
 
         if (points.size() == 0) {
             if (input.IsPressed(Core::Mouse::LEFT)) {
-                points.push(cursor);
+                // Clicking an object selects it, clicking empty space starts a selection box
+                auto picked = PickUnderMouse(controller, LayerFilter::Editable);
+                if (picked->NotValid()) {
+                    points.push(cursor);
+                } else {
+                    controller.GetRegistry().Select({picked});
+                }
             }
         } else if (points.size() == 1) {
             // Draw the selection box
@@ -137,39 +113,129 @@ struct SelectionModeHandler : public InputHandler {
             float width = bottomright.x - topleft.x;
             float height = bottomright.y - topleft.y;
 
+            // Dragging to the right picks what is entirely inside the box, dragging to the left also what crosses it
+            bool crossing = cursor.x < point.x;
+
             {
                 // Draw the selection box
+                auto color = crossing ? Core::Color::GREEN : Core::Color::ORANGE;
                 Core::Vector2 topright = topleft + Core::Vector2(width, 0);
                 Core::Vector2 bottomleft = topleft + Core::Vector2(0, height);
-                graphics.DrawDotted(Core::Color::ORANGE, topleft.x, topleft.y, topright.x, topright.y, 5);
-                graphics.DrawDotted(Core::Color::ORANGE, topleft.x, topleft.y, bottomleft.x, bottomleft.y, 5);
-                graphics.DrawDotted(Core::Color::ORANGE, bottomright.x, bottomright.y, topright.x, topright.y, 5);
-                graphics.DrawDotted(Core::Color::ORANGE, bottomright.x, bottomright.y, bottomleft.x, bottomleft.y, 5);
+                graphics.DrawDotted(color, topleft.x, topleft.y, topright.x, topright.y, 5);
+                graphics.DrawDotted(color, topleft.x, topleft.y, bottomleft.x, bottomleft.y, 5);
+                graphics.DrawDotted(color, bottomright.x, bottomright.y, topright.x, topright.y, 5);
+                graphics.DrawDotted(color, bottomright.x, bottomright.y, bottomleft.x, bottomleft.y, 5);
             }
 
             if (input.IsPressed(Core::Mouse::LEFT)) {
-                // Perform the selection
+                // Perform the selection, the box narrows the search to the layer indexes' cells under it
                 auto& registry = controller.GetRegistry();
                 auto topleft_world = transform.Inverse().Apply(topleft);
-                float world_width = width / transform.scale;
-                float world_height = height / transform.scale;
-                SelectionVisitor visitor(topleft_world, world_width, world_height);
-                registry.VisitObjects(visitor);
+                Core::Bounds box(topleft_world,
+                    topleft_world + Core::Vector2(width / transform.scale, height / transform.scale));
+                auto area = crossing ? Query::Crosses(box) : Query::Inside(box);
+                registry.Select(registry.QueryObjects(area && Query::OnLayers(LayerFilter::Editable)));
                 points.pop();
             }
         }
     }
 };
 
+// Screen space outline drawn clockwise selects what is entirely inside it, counterclockwise also what it crosses
+static bool IsCrossingOutline(const std::vector<Core::Vector2>& points) { return PolygonWinding(points) < 0; }
+
+// The outline so far, closed back to its first point
+static void DrawSelectionOutline(Core::Graphics& graphics, const std::vector<Core::Vector2>& points) {
+    auto color = IsCrossingOutline(points) ? Core::Color::GREEN : Core::Color::ORANGE;
+    for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+        graphics.DrawDotted(color, points[j].x, points[j].y, points[i].x, points[i].y, 5);
+    }
+}
+
+static void SelectInOutline(Cad::Controller& controller, const std::vector<Core::Vector2>& points) {
+    auto inverse = controller.GetViewfinder().GetViewTransform().Inverse();
+    std::vector<Core::Vector2> polygon;
+    for (auto& point : points) {
+        polygon.push_back(inverse.Apply(point));
+    }
+    auto& registry = controller.GetRegistry();
+    registry.Select(SelectInPolygon(registry, polygon, IsCrossingOutline(points), LayerFilter::Editable));
+}
+
+// Freeform selection: hold the left button and draw around the objects, releasing it selects them
+struct LassoSelectionHandler : public InputHandler {
+    std::vector<Core::Vector2> points;
+
+    void OnInput(Cad::Controller& controller) override {
+        auto& input = controller.GetInput();
+        auto mouse = input.GetMousePosition();
+
+        if (points.empty()) {
+            if (input.IsPressed(Core::Mouse::LEFT)) points.push_back(mouse);
+            return;
+        }
+
+        // A vertex every few pixels is smooth enough and keeps a slow drag from adding one per frame
+        if ((mouse - points.back()).Length() >= 4) points.push_back(mouse);
+        DrawSelectionOutline(controller.GetGraphics(), points);
+
+        if (!input.IsHeld(Core::Mouse::LEFT)) {
+            SelectInOutline(controller, points);
+            points.clear();
+        }
+    }
+};
+
+// Polygon selection: click the corners, Backspace takes the last one back and Enter selects
+struct FenceSelectionHandler : public InputHandler {
+    std::vector<Core::Vector2> points;
+
+    void OnInput(Cad::Controller& controller) override {
+        auto& input = controller.GetInput();
+        auto cursor = controller.GetViewfinder().GetCursor(controller);
+
+        if (input.IsPressed(Core::Mouse::LEFT)) points.push_back(cursor);
+        if (input.IsPressed(Core::Key::Backspace) && !points.empty()) points.pop_back();
+        if (points.empty()) return;
+
+        points.push_back(cursor);
+        DrawSelectionOutline(controller.GetGraphics(), points);
+        points.pop_back();
+
+        if (input.IsPressed(Core::Key::Enter)) {
+            SelectInOutline(controller, points);
+            points.clear();
+        }
+    }
+};
+
 struct LineCreateHandler : public InputHandler {
     std::stack<Core::Vector2> points;
-    std::vector<Ray> rays;
+    // Guide rays this handler put in the bank. They stay there until the line is finished or abandoned, the ones
+    // through the start point move with it.
+    RayBank* ray_bank = nullptr;
+    std::vector<RayId> rays;
+    std::vector<RayId> start_rays;
+    Core::Vector2 start_rays_point;
+
+    ~LineCreateHandler() {
+        RemoveRays(rays);
+        RemoveRays(start_rays);
+    }
+
+    void RemoveRays(std::vector<RayId>& ids) {
+        for (RayId id : ids) {
+            ray_bank->RemoveRay(id);
+        }
+        ids.clear();
+    }
 
     void OnInput(Cad::Controller& controller) {
         auto& input = controller.GetInput();
         auto cursor = controller.GetViewfinder().GetCursor(controller);
         auto transform = controller.GetViewfinder().GetViewTransform();
         auto cursor_world = transform.Inverse().Apply(cursor);
+        ray_bank = &controller.GetRayBank();
 
         if (input.IsPressed(Core::Mouse::LEFT)) {
             points.push(cursor_world);
@@ -177,16 +243,15 @@ struct LineCreateHandler : public InputHandler {
 
         if (input.IsPressed(Core::Key::Escape) || input.IsPressed(Core::Key::Space)) {
             points = std::stack<Core::Vector2>();
-            rays = std::vector<Ray>();
-
+            RemoveRays(rays);
         }
 
         if (input.IsPressed(Core::Key::Up)) {
-            rays.push_back(Ray(cursor_world, Core::Vector2(0, 1), Core::Color::RED.Darker()));
+            rays.push_back(ray_bank->AddRay(cursor_world, Core::Vector2(0, 1), Core::Color::RED.Darker()));
         }
 
         if (input.IsPressed(Core::Key::Left)) {
-            rays.push_back(Ray(cursor_world, Core::Vector2(1, 0), Core::Color::GREEN.Darker()));
+            rays.push_back(ray_bank->AddRay(cursor_world, Core::Vector2(1, 0), Core::Color::GREEN.Darker()));
         }
 
         if (input.IsPressed(Core::Mouse::RIGHT)) {
@@ -197,17 +262,20 @@ struct LineCreateHandler : public InputHandler {
             return;
         }
 
+        if (points.size() != 1 || !(points.top() == start_rays_point)) {
+            RemoveRays(start_rays);
+        }
+
         if (points.size() == 1) {
             auto& graphics = controller.GetGraphics();
             auto& point = points.top();
             auto length = (cursor_world - point).Length();
 
-            // add any rays we may have
-            for (auto& ray : rays) {
-                controller.GetRayBank().AddRay(ray);
+            if (start_rays.empty()) {
+                start_rays.push_back(ray_bank->AddRay(point, Core::Vector2(0, 1), Core::Color::RED.Darker()));
+                start_rays.push_back(ray_bank->AddRay(point, Core::Vector2(1, 0), Core::Color::GREEN.Darker()));
+                start_rays_point = point;
             }
-            controller.GetRayBank().AddRay(point, Core::Vector2(0, 1), Core::Color::RED.Darker());
-            controller.GetRayBank().AddRay(point, Core::Vector2(1, 0), Core::Color::GREEN.Darker());
 
             graphics.PushTransform(transform);
             graphics.DrawDotted(Core::Color::WHITE, point.x, point.y, cursor_world.x, cursor_world.y, 3);
@@ -236,83 +304,58 @@ struct LineCreateHandler : public InputHandler {
             points.pop();
             auto builder = Cad::LineObjectBuilder(start, end);
             controller.GetRegistry().CreateObject(builder);
-            rays = std::vector<Ray>();
+            RemoveRays(rays);
+            RemoveRays(start_rays);
         }
     }
 };
 
-struct AreSelectedPredicate : public ObjectPredicate {
-    AreSelectedPredicate() = default;
-    virtual bool Match(Object& object) { return object.IsSelected(); }
-};
-
-struct TranslatedRenderVisitor : public ObjectVisitor {
-    Core::Vector2 delta;
-    Core::Graphics& graphics;
-
-    TranslatedRenderVisitor(Core::Vector2 delta, Core::Graphics& graphics) : delta(delta), graphics(graphics) {}
-
-    void Visit(LineObject& object) override {
-        auto start = object.start + delta;
-        auto end = object.end + delta;
-
-        auto color = Core::Color::BROWN;
-        graphics.DrawLine(color, start.x, start.y, end.x, end.y);
-    }
-
-    void Visit(CircleObject& object) override {
-        auto center = object.center + delta;
-        auto radius = object.radius;
-        auto color = Core::Color::BROWN;
-        graphics.DrawCircle(color, center.x, center.y, radius);
-    }
-
-    void Visit(PolylineObject& object) override {}
-};
-
-struct TranslateObjectVisitor : public ObjectVisitor {
-    Core::Vector2 delta;
-
-    TranslateObjectVisitor(Core::Vector2 delta) : delta(delta) {}
-
-    void Visit(LineObject& object) override {
-        object.start += delta;
-        object.end += delta;
-    }
-
-    void Visit(CircleObject& object) override { object.center += delta; }
-
-    void Visit(PolylineObject& object) override {}
-};
-
 struct TranslateModeHandler : public InputHandler {
     std::stack<Core::Vector2> points;
+    SelectionPreview preview;
+    // Arrow keys nudge the selection by a few pixels, a run of nudges is undone as one
+    bool nudging = false;
     TranslateModeHandler() = default;
+
+    void Nudge(Cad::Controller& controller, Core::Vector2 direction) {
+        float step = 10 / controller.GetViewfinder().GetViewTransform().scale;
+        auto& registry = controller.GetRegistry();
+        registry.BeginChange("nudge", nudging);
+        registry.TransformSelection(Core::Matrix3::Translation(direction.x * step, direction.y * step));
+        registry.EndChange();
+        nudging = true;
+    }
+
     void OnInput(Cad::Controller& controller) {
         auto& input = controller.GetInput();
         auto cursor = controller.GetViewfinder().GetCursor(controller);
         auto transform = controller.GetViewfinder().GetViewTransform();
         auto cursor_world = transform.Inverse().Apply(cursor);
 
+        if (points.empty()) {
+            if (input.IsPressed(Core::Key::Up)) Nudge(controller, Core::Vector2(0, -1));
+            if (input.IsPressed(Core::Key::Down)) Nudge(controller, Core::Vector2(0, 1));
+            if (input.IsPressed(Core::Key::Left)) Nudge(controller, Core::Vector2(-1, 0));
+            if (input.IsPressed(Core::Key::Right)) Nudge(controller, Core::Vector2(1, 0));
+        }
+
         if (points.empty() && input.IsPressed(Core::Mouse::LEFT)) {
             points.push(cursor_world);
+            nudging = false;
         }
 
         else if (points.size() == 1) {
             auto delta = cursor_world - points.top();
-            auto predicate = AreSelectedPredicate();
-            auto selected = controller.GetRegistry().QueryObjects(predicate);
+            preview.Draw(controller, delta);
             controller.GetGraphics().PushTransform(transform);
-            TranslatedRenderVisitor visitor(delta, controller.GetGraphics());
-            controller.GetRegistry().VisitObjects(selected, visitor);
             controller.GetGraphics().DrawDotted(
                 Core::Color::RED, points.top().x, points.top().y, cursor_world.x, cursor_world.y, 5);
             controller.GetGraphics().PopTransform();
 
             if (input.IsPressed(Core::Mouse::LEFT)) {
                 points.pop();
-                TranslateObjectVisitor visitor(delta);
-                controller.GetRegistry().VisitObjects(selected, visitor);
+                preview.Reset();
+                controller.GetRegistry().TransformSelection(Core::Matrix3::Translation(delta.x, delta.y));
             }
         }
     }
@@ -321,35 +364,69 @@ struct TranslateModeHandler : public InputHandler {
 void Application::OnStart(Controller& controller) {
     editor.OnStart(controller);
 
+    // The axes through the origin are guides for the whole session
+    ray_bank->AddRay(Core::Vector2(0, 0), Core::Vector2(0, 1), Core::Color::RED);
+    ray_bank->AddRay(Core::Vector2(0, 0), Core::Vector2(1, 0), Core::Color::GREEN);
+
     viewfinder->Zero(controller);
     viewfinder->Pan(0, 0);
     viewfinder->Zoom(10);
 }
 
-struct CopyVisitor : ObjectVisitor {
-    Cad::ObjectRegistry& registry;
+// Builds the moved copies, which the caller hands to the registry a layer at a time
+struct CopyVisitor : ConstObjectVisitor {
+    std::vector<std::unique_ptr<Object>> copies;
     Core::Vector2 delta;
 
-    CopyVisitor(Cad::ObjectRegistry& registry, Core::Vector2 delta) : registry(registry), delta(delta) {}
+    CopyVisitor(Core::Vector2 delta) : delta(delta) {}
 
-    void Visit(LineObject& object) override {
+    void Visit(const LineObject& object) override {
         auto start = object.start + delta;
         auto end = object.end + delta;
         auto builder = Cad::LineObjectBuilder(start, end);
-        registry.CreateObject(builder);
+        copies.push_back(builder.Build());
     }
 
-    void Visit(CircleObject& object) override {
+    void Visit(const CircleObject& object) override {
         auto center = object.center + delta;
         auto builder = Cad::CircleObjectBuilder(center, object.radius);
-        registry.CreateObject(builder);
+        copies.push_back(builder.Build());
     }
 
-    void Visit(PolylineObject& object) override {}
+    void Visit(const PolylineObject& object) override {
+        VertexList points;
+        points.reserve(object.points.size());
+        for (auto& point : object.points) {
+            points.push_back(point + delta);
+        }
+        auto builder = Cad::PolylineObjectBuilder(std::move(points));
+        copies.push_back(builder.Build());
+    }
+
+    // Copies of an insert share its block definition
+    void Visit(const InsertObject& object) override {
+        Core::Transform transform = object.transform;
+        transform.Translate(delta.x, delta.y);
+        auto builder = Cad::InsertObjectBuilder(object.block, transform);
+        copies.push_back(builder.Build());
+    }
+
+    // The copy keeps the loops but not the boundary IDs, it was not traced from those objects
+    void Visit(const HatchObject& object) override {
+        auto loops = object.loops;
+        for (auto& loop : loops) {
+            for (auto& point : loop) {
+                point += delta;
+            }
+        }
+        auto builder = Cad::HatchObjectBuilder(std::move(loops), {}, object.angle, object.spacing, object.rule);
+        copies.push_back(builder.Build());
+    }
 };
 
 struct CopyInputHandler : public InputHandler {
     std::stack<Core::Vector2> points;
+    SelectionPreview preview;
     CopyInputHandler() = default;
     void OnInput(Cad::Controller& controller) {
         auto& input = controller.GetInput();
@@ -361,19 +438,33 @@ struct CopyInputHandler : public InputHandler {
             points.push(cursor_world);
         } else if (points.size() == 1) {
             auto delta = cursor_world - points.top();
-            auto predicate = AreSelectedPredicate();
-            auto selected = controller.GetRegistry().QueryObjects(predicate);
+            preview.Draw(controller, delta);
             controller.GetGraphics().PushTransform(transform);
-            TranslatedRenderVisitor visitor(delta, controller.GetGraphics());
-            controller.GetRegistry().VisitObjects(selected, visitor);
             controller.GetGraphics().DrawDotted(
                 Core::Color::RED, points.top().x, points.top().y, cursor_world.x, cursor_world.y, 5);
             controller.GetGraphics().PopTransform();
 
             if (input.IsPressed(Core::Mouse::LEFT)) {
                 points.pop();
-                CopyVisitor visitor(controller.GetRegistry(), delta);
-                controller.GetRegistry().VisitObjects(selected, visitor);
+                preview.Reset();
+                auto& registry = controller.GetRegistry();
+                // Each copy goes on the layer of the object it was copied from
+                std::map<LayerId, std::vector<ObjectRegistry::Reference>> sources;
+                for (auto& reference : registry.GetSelected()) {
+                    sources[registry.LayerOf(reference)].push_back(reference);
+                }
+
+                registry.BeginChange("copy");
+                LayerId current = registry.GetCurrentLayer();
+                for (auto& [layer, references] : sources) {
+                    CopyVisitor visitor(delta);
+                    visitor.copies.reserve(references.size());
+                    registry.VisitObjects(references, visitor);
+                    registry.SetCurrentLayer(layer);
+                    registry.CreateObjects(std::move(visitor.copies));
+                }
+                registry.SetCurrentLayer(current);
+                registry.EndChange();
             }
         }
     }
@@ -400,8 +491,15 @@ void Editor::OnUpdate(Cad::Controller& controller) {
     auto& input = controller.GetInput();
 
     if (input.IsHeld(Core::Key::LControl) && input.IsPressed(Core::Key::A)) {
-        DeselectAllVisitor visitor;
-        controller.GetRegistry().VisitObjects(visitor);
+        controller.GetRegistry().DeselectAll();
+    }
+
+    if (input.IsHeld(Core::Key::LControl) && input.IsPressed(Core::Key::Z)) {
+        controller.GetRegistry().Undo();
+    }
+
+    if (input.IsHeld(Core::Key::LControl) && input.IsPressed(Core::Key::Y)) {
+        controller.GetRegistry().Redo();
     }
 
     if (input.IsPressed(Core::Key::L)) {
@@ -412,6 +510,14 @@ void Editor::OnUpdate(Cad::Controller& controller) {
         input_handler = std::make_unique<SelectionModeHandler>();
     }
 
+    if (input.IsPressed(Core::Key::O)) {
+        input_handler = std::make_unique<LassoSelectionHandler>();
+    }
+
+    if (input.IsPressed(Core::Key::F)) {
+        input_handler = std::make_unique<FenceSelectionHandler>();
+    }
+
     if (input.IsPressed(Core::Key::T)) {
         input_handler = std::make_unique<TranslateModeHandler>();
     }
@@ -425,35 +531,46 @@ void Editor::OnUpdate(Cad::Controller& controller) {
     }
 
     if (input.IsPressed(Core::Key::Delete)) {
-        AreSelectedPredicate predicate;
-        auto selected = controller.GetRegistry().QueryObjects(predicate);
+        auto selected = controller.GetRegistry().GetSelected();
         controller.GetRegistry().DeleteObjects(selected);
     }
 
     if (input.IsPressed(Core::Key::Escape)) {
         input_handler = std::make_unique<NoOpInputHandler>();
 
-        DeselectAllVisitor visitor;
-        controller.GetRegistry().VisitObjects(visitor);
+        controller.GetRegistry().DeselectAll();
     }
 
     auto& registry = controller.GetRegistry();
     auto& ray_bank = controller.GetRayBank();
-    controller.GetViewfinder().Update(controller, registry, ray_bank);
+    controller.GetViewfinder().Update(
+        controller, registry, ray_bank, controller.GetSnapIndex(), controller.GetIntersections());
 }
 
 void Editor::OnRender(Cad::Controller& controller) {
     auto& registry = controller.GetRegistry();
     auto& ray_bank = controller.GetRayBank();
-    controller.GetRayBank().AddRay(Core::Vector2(0, 0), Core::Vector2(0, 1), Core::Color::RED);
-    controller.GetRayBank().AddRay(Core::Vector2(0, 0), Core::Vector2(1, 0), Core::Color::GREEN);
     controller.GetViewfinder().Render(controller, registry, ray_bank);
     Core::Transform view_transform = controller.GetViewfinder().GetViewTransform();
     controller.GetRayBank().Draw(controller.GetGraphics(), view_transform);
-    controller.GetRayBank().Clear();
     controller.GetGraphics().PushTransform(view_transform);
-    RendererVisitor renderer(controller.GetGraphics());
-    controller.GetRegistry().VisitObjects(renderer);
+    // Only draw what is on screen
+    auto& graphics = controller.GetGraphics();
+    Core::Transform inverse = view_transform.Inverse();
+    Core::Bounds view_rect = Core::Bounds::FromPoints(
+        inverse.Apply(Core::Vector2(0, 0)), inverse.Apply(Core::Vector2(graphics.GetWidth(), graphics.GetHeight())));
+    RendererVisitor renderer(graphics, registry);
+    registry.VisitObjects(view_rect, renderer, LayerFilter::Visible);
+
+    // Highlight the object a click would select
+    if (!NotFocused()) {
+        auto hovered = PickUnderMouse(controller, LayerFilter::Editable);
+        if (!hovered->NotValid()) {
+            RendererVisitor highlighter(graphics, registry);
+            highlighter.highlight = Core::Color::YELLOW;
+            registry.VisitObjects({hovered}, highlighter);
+        }
+    }
     controller.GetGraphics().PopTransform();
 }
 
@@ -559,6 +676,10 @@ Application::Application() {
     viewfinder = std::make_unique<Viewfinder>();
     dispatcher = std::make_shared<Dispatcher>();
     ray_bank = std::make_unique<RayBank>();
+    endpoint_graph = std::make_unique<EndpointGraph>();
+    measurements = std::make_unique<MeasurementCache>();
+    intersections = std::make_unique<IntersectionIndex>();
+    snap_index = std::make_unique<SnapIndex>();
 
     root.position = Core::Vector2(0, 280);
     root.size = Core::Vector2(200, 275);
@@ -1,6 +1,17 @@
 #include <cad/Command.h>
 #include <cad/Dispatcher.h>
+#include <cad/object/Block.h>
+#include <cad/object/Dedupe.h>
+#include <cad/object/Edit.h>
+#include <cad/object/ObjectMetrics.h>
+#include <cad/object/ObjectVisitor.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
 #include <regex>
+#include <sstream>
+#include <unordered_set>
 
 namespace Cad {
 
@@ -152,21 +163,636 @@ void Dispatcher::Dispatch(std::string command_string, Core::Output& stream)
     // Enqueue the command
     Syntax::ArgSignature& signature = *matching_signature.value();
     std::unique_ptr<Command> command = signature.Create(parsed_args);
-    command_queue.push(std::move(command));
+    command_queue.emplace(command_keyword, std::move(command));
 }
 
 void Dispatcher::Execute(Controller& controller) {
-    for (int i = 0; i < command_queue.size(); i++) {
-        std::unique_ptr<Command> command = std::move(command_queue.front());
+    while (!command_queue.empty()) {
+        auto [keyword, command] = std::move(command_queue.front());
         command_queue.pop();
+        // Whatever a command changes in the drawing is undone in one step, named after the command
+        controller.GetRegistry().BeginChange(keyword);
         command->Forward(controller);
-        // TODO: add undo stack to dispatcher
+        controller.GetRegistry().EndChange();
     }
+}
 
-    // Clear the command queue
-    while (!command_queue.empty()) {
-        command_queue.pop();
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Layers                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+std::optional<Core::Pixel> ColorByName(const std::string& name)
+{
+    static const std::pair<const char*, Core::Pixel> colors[] = {
+        {"black", Core::Color::BLACK},
+        {"darkgray", Core::Color::DARK_GRAY},
+        {"gray", Core::Color::GRAY},
+        {"lightgray", Core::Color::LIGHT_GRAY},
+        {"white", Core::Color::WHITE},
+        {"red", Core::Color::RED},
+        {"cyan", Core::Color::CYAN},
+        {"purple", Core::Color::PURPLE},
+        {"green", Core::Color::GREEN},
+        {"blue", Core::Color::BLUE},
+        {"yellow", Core::Color::YELLOW},
+        {"orange", Core::Color::ORANGE},
+        {"brown", Core::Color::BROWN},
+    };
+    for (auto& [color_name, color] : colors) {
+        if (name == color_name) return color;
+    }
+    return std::nullopt;
+}
+} // namespace
+
+void LayerCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& output = cad.GetOutput();
+
+    if (attribute.empty()) {
+        registry.SetCurrentLayer(registry.CreateLayer(name));
+        output.Writeln("Current layer: " + name);
+        return;
+    }
+
+    auto layer = registry.FindLayer(name);
+    if (!layer) {
+        output.Writeln("[ERROR]: No such layer: " + name);
+        return;
+    }
+
+    if (attribute == "show") {
+        registry.SetLayerVisible(layer.value(), true);
+    } else if (attribute == "hide") {
+        registry.SetLayerVisible(layer.value(), false);
+    } else if (attribute == "lock") {
+        registry.SetLayerLocked(layer.value(), true);
+    } else if (attribute == "unlock") {
+        registry.SetLayerLocked(layer.value(), false);
+    } else if (auto color = ColorByName(attribute)) {
+        registry.SetLayerColor(layer.value(), color.value());
+    } else {
+        output.Writeln("[ERROR]: Unrecognized layer attribute: " + attribute);
+    }
+}
+
+void LayersCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& output = cad.GetOutput();
+    for (LayerId id = 0; id < registry.LayerCount(); id++) {
+        const Layer& layer = registry.GetLayer(id);
+        std::string line = (id == registry.GetCurrentLayer() ? "* " : "  ") + layer.name + ": ";
+        line += std::to_string(registry.CountOnLayer(id)) + " objects";
+        if (!layer.visible) line += ", hidden";
+        if (layer.locked) line += ", locked";
+        output.Writeln(line);
+    }
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Blocks                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+void BlockCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& output = cad.GetOutput();
+
+    auto selected = registry.GetSelected();
+    if (selected.empty()) {
+        output.Writeln("[ERROR]: Nothing selected");
+        return;
+    }
+
+    auto transform = cad.GetViewfinder().GetViewTransform();
+    auto base_point = transform.Inverse().Apply(cad.GetViewfinder().GetCursor(cad));
+    auto block = registry.DefineBlock(name, selected, base_point);
+    registry.DeleteObjects(selected);
+
+    auto builder = InsertObjectBuilder(block, Core::Transform(base_point.x, base_point.y, 1, 0));
+    registry.CreateObject(builder);
+    output.Writeln("Block " + name + ": " + std::to_string(block->objects.size()) + " objects");
+}
+
+void InsertCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto block = registry.FindBlock(name);
+    if (block == nullptr) {
+        cad.GetOutput().Writeln("[ERROR]: No such block: " + name);
+        return;
+    }
+
+    auto builder = InsertObjectBuilder(block, Core::Transform(position.x, position.y, scale, rotation * M_PI / 180));
+    registry.CreateObject(builder);
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Transforms                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+void TransformCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    size_t count = registry.GetSelection().size();
+    if (count == 0) {
+        cad.GetOutput().Writeln("[ERROR]: Nothing selected");
+        return;
+    }
+    registry.TransformSelection(matrix);
+    cad.GetOutput().Writeln("Transformed: " + std::to_string(count) + " objects");
+}
+
+std::vector<Core::Matrix3> ArrayCommand::Rectangular(int rows, int columns, Core::Vector2 spacing)
+{
+    std::vector<Core::Matrix3> placements;
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            if (row == 0 && column == 0) continue;
+            placements.push_back(Core::Matrix3::Translation(column * spacing.x, row * spacing.y));
+        }
+    }
+    return placements;
+}
+
+std::vector<Core::Matrix3> ArrayCommand::Polar(int count, float angle, Core::Vector2 center)
+{
+    // A full turn spreads the items evenly without putting the last one on top of the first
+    bool full = std::abs(std::abs(angle) - 360) < 1e-3f;
+    float step = count < 2 ? 0 : angle / (full ? count : count - 1);
+
+    std::vector<Core::Matrix3> placements;
+    for (int i = 1; i < count; i++) {
+        placements.push_back(Core::Matrix3::Rotation(center, i * step * M_PI / 180));
+    }
+    return placements;
+}
+
+void ArrayCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& output = cad.GetOutput();
+
+    auto selected = registry.GetSelected();
+    if (selected.empty()) {
+        output.Writeln("[ERROR]: Nothing selected");
+        return;
+    }
+
+    // Copies go on the layer of the object they were copied from, and the inserts of an instanced array on the layer
+    // of the objects in their block, so the selection is split by layer
+    std::map<LayerId, std::vector<ObjectRegistry::Reference>> sources;
+    for (auto& reference : selected) {
+        sources[registry.LayerOf(reference)].push_back(reference);
+    }
+
+    LayerId current = registry.GetCurrentLayer();
+    for (auto& [layer, references] : sources) {
+        std::vector<std::unique_ptr<Object>> copies;
+        if (instanced) {
+            // One block in world coordinates, so that each placement is also the transform of its insert
+            std::string name = "array";
+            for (int n = 1; registry.FindBlock(name) != nullptr; n++) {
+                name = "array" + std::to_string(n);
+            }
+            auto block = registry.DefineBlock(name, references, Core::Vector2(0, 0));
+            copies.reserve(placements.size());
+            for (auto& matrix : placements) {
+                float rotation = std::atan2(matrix.data[3], matrix.data[0]);
+                copies.push_back(std::make_unique<InsertObject>(
+                    block, Core::Transform(matrix.data[2], matrix.data[5], 1, rotation)));
+            }
+        } else {
+            copies.reserve(placements.size() * references.size());
+            for (auto& matrix : placements) {
+                registry.Visit(references, [&copies, &matrix](auto& object) {
+                    auto copy = object.Clone();
+                    // The copies of a hatch were not traced from its boundary objects
+                    if constexpr (std::is_same_v<std::decay_t<decltype(object)>, HatchObject>) {
+                        static_cast<HatchObject&>(*copy).boundaries.clear();
+                    }
+                    TransformObject(*copy, matrix);
+                    copies.push_back(std::move(copy));
+                });
+            }
+        }
+
+        registry.SetCurrentLayer(layer);
+        registry.CreateObjects(std::move(copies));
+    }
+    registry.SetCurrentLayer(current);
+    output.Writeln("Array: " + std::to_string(placements.size()) + " copies");
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                Trim, extend, offset                                                */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+
+// Objects are picked within a few pixels of the point, as with the mouse
+float PickTolerance(Cad::Controller& cad) { return 5 / cad.GetViewfinder().GetViewTransform().scale; }
+
+} // namespace
+
+void TrimCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& output = cad.GetOutput();
+
+    std::vector<TrimPick> picks;
+    if (b) {
+        picks = FencePicks(registry, a, *b);
+    } else {
+        auto reference = registry.Pick(a, PickTolerance(cad), LayerFilter::Editable);
+        if (!reference->NotValid()) picks.push_back(TrimPick{registry.GetId(reference), a});
+    }
+    if (picks.empty()) {
+        output.Writeln("[ERROR]: Nothing to trim");
+        return;
+    }
+    output.Writeln("Trimmed: " + std::to_string(TrimObjects(registry, picks)));
+}
+
+void ExtendCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& output = cad.GetOutput();
+
+    std::vector<ObjectId> ids = registry.GetSelection();
+    if (point) {
+        auto reference = registry.Pick(*point, PickTolerance(cad), LayerFilter::Editable);
+        ids.clear();
+        if (!reference->NotValid()) ids.push_back(registry.GetId(reference));
+    }
+    if (ids.empty()) {
+        output.Writeln("[ERROR]: Nothing to extend");
+        return;
+    }
+    output.Writeln("Extended: " + std::to_string(ExtendObjects(registry, ids, point)));
+}
+
+void OffsetCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& output = cad.GetOutput();
+
+    if (registry.GetSelection().empty()) {
+        output.Writeln("[ERROR]: Nothing selected");
+        return;
+    }
+    output.Writeln("Offset: " + std::to_string(OffsetObjects(registry, registry.GetSelection(), distance)) + " copies");
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                        Undo                                                        */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+void UndoCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& output = cad.GetOutput();
+    for (int i = 0; i < steps; i++) {
+        auto label = redo ? registry.Redo() : registry.Undo();
+        if (!label) {
+            output.Writeln(redo ? "Nothing to redo" : "Nothing to undo");
+            return;
+        }
+        output.Writeln((redo ? "Redone: " : "Undone: ") + label.value());
+    }
+}
+
+void UndoBudgetCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    registry.SetUndoBudget(size_t(std::max(megabytes, 0.0f) * (1 << 20)));
+
+    auto& history = registry.GetHistory();
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "Undo history: " << history.GetUsed() / float(1 << 20) << " of " << history.GetBudget() / float(1 << 20)
+       << " MB, " << history.UndoCount() << " steps";
+    cad.GetOutput().Writeln(ss.str());
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    Connectivity                                                    */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+// Chains only run through editable layers, locked and hidden linework is left alone
+std::function<bool(ObjectId)> IsEditable(const ObjectRegistry& registry)
+{
+    return [&registry](ObjectId id) {
+        auto reference = registry.Find(id);
+        return !reference->NotValid() && registry.IsAccepted(registry.LayerOf(reference), LayerFilter::Editable);
+    };
+}
+
+void AppendVertices(const LineObject& line, bool reversed, VertexList& points)
+{
+    points.push_back(reversed ? line.end : line.start);
+    points.push_back(reversed ? line.start : line.end);
+}
+
+void AppendVertices(const PolylineObject& polyline, bool reversed, VertexList& points)
+{
+    if (reversed) {
+        points.insert(points.end(), polyline.points.rbegin(), polyline.points.rend());
+    } else {
+        points.insert(points.end(), polyline.points.begin(), polyline.points.end());
+    }
+}
+
+void AppendVertices(const Object&, bool, VertexList&) {}
+} // namespace
+
+void ChainCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& graph = cad.GetEndpointGraph();
+
+    std::vector<ObjectId> chained;
+    std::unordered_set<ObjectId> seen;
+    for (auto& reference : registry.GetSelected()) {
+        if (seen.count(registry.GetId(reference))) continue;
+        for (auto& link : graph.Chain(registry.GetId(reference), IsEditable(registry))) {
+            if (seen.insert(link.id).second) chained.push_back(link.id);
+        }
+    }
+
+    registry.Select(registry.Find(chained));
+    cad.GetOutput().Writeln("Chained: " + std::to_string(chained.size()) + " objects");
+}
+
+void JoinCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+
+    std::unordered_set<ObjectId> seen;
+    int joined = 0;
+    for (auto& reference : registry.GetSelected()) {
+        ObjectId seed = registry.GetId(reference);
+        if (seen.count(seed)) continue;
+
+        // Each join changes the drawing, so the graph is synced again for every chain
+        auto& graph = cad.GetEndpointGraph();
+        auto chain = graph.Chain(seed, IsEditable(registry));
+        std::vector<ObjectId> ids;
+        for (auto& link : chain) {
+            seen.insert(link.id);
+            ids.push_back(link.id);
+        }
+        if (chain.size() < 2) continue;
+
+        // Consecutive objects share their meeting point, only the first copy of it is kept
+        VertexList points;
+        for (auto& link : chain) {
+            size_t first = points.size();
+            registry.Visit(std::vector<ObjectRegistry::Reference>{registry.Find(link.id)},
+                [&](auto& object) { AppendVertices(object, link.reversed, points); });
+            if (first > 0 && points.size() > first) points.erase(points.begin() + first);
+        }
+        if ((points.back() - points.front()).Length() <= graph.GetTolerance()) points.back() = points.front();
+
+        auto refs = registry.Find(ids);
+        LayerId current_layer = registry.GetCurrentLayer();
+        registry.SetCurrentLayer(registry.LayerOf(refs.front()));
+        registry.DeleteObjects(refs);
+        auto builder = PolylineObjectBuilder(std::move(points));
+        registry.CreateObject(builder);
+        registry.SetCurrentLayer(current_layer);
+        joined++;
+    }
+
+    cad.GetOutput().Writeln("Joined: " + std::to_string(joined) + " chains");
+}
+
+void OpenEndsCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& graph = cad.GetEndpointGraph();
+
+    auto editable = IsEditable(registry);
+    std::vector<ObjectId> ids;
+    std::unordered_set<ObjectId> seen;
+    size_t count = 0;
+    for (auto& end : graph.OpenEnds()) {
+        if (!editable(end.id)) continue;
+        count++;
+        if (seen.insert(end.id).second) ids.push_back(end.id);
+    }
+
+    registry.Select(registry.Find(ids));
+    cad.GetOutput().Writeln("Open ends: " + std::to_string(count));
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Hatch                                                        */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+// Segments a circle's loop is traced with
+constexpr int CIRCLE_LOOP_SEGMENTS = 128;
+} // namespace
+
+void HatchCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& output = cad.GetOutput();
+
+    std::vector<std::vector<Core::Vector2>> loops;
+    std::vector<ObjectId> boundaries;
+    std::unordered_set<ObjectId> seen;
+    for (auto& reference : registry.GetSelected()) {
+        ObjectId seed = registry.GetId(reference);
+        if (seen.count(seed)) continue;
+
+        std::vector<Core::Vector2> loop;
+        registry.Visit(std::vector<ObjectRegistry::Reference>{reference}, [&loop](auto& object) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(object)>, CircleObject>) {
+                for (int k = 0; k < CIRCLE_LOOP_SEGMENTS; k++) {
+                    float angle = 2 * M_PI * k / CIRCLE_LOOP_SEGMENTS;
+                    loop.push_back(object.center + Core::Vector2::FromAngle(angle) * object.radius);
+                }
+            }
+        });
+        if (!loop.empty()) {
+            seen.insert(seed);
+            loops.push_back(std::move(loop));
+            boundaries.push_back(seed);
+            continue;
+        }
+
+        // Everything else is traced as the chain through it, which is a loop if it comes back to where it started
+        auto& graph = cad.GetEndpointGraph();
+        auto chain = graph.Chain(seed, IsEditable(registry));
+        VertexList points;
+        for (auto& link : chain) {
+            seen.insert(link.id);
+            size_t first = points.size();
+            registry.Visit(std::vector<ObjectRegistry::Reference>{registry.Find(link.id)},
+                [&](auto& object) { AppendVertices(object, link.reversed, points); });
+            if (first > 0 && points.size() > first) points.erase(points.begin() + first);
+        }
+        if (points.size() < 4 || (points.back() - points.front()).Length() > graph.GetTolerance()) continue;
+        points.pop_back();
+        loops.emplace_back(points.begin(), points.end());
+        for (auto& link : chain) {
+            boundaries.push_back(link.id);
+        }
+    }
+    if (loops.empty()) {
+        output.Writeln("[ERROR]: No closed boundaries selected");
+        return;
+    }
+
+    size_t count = loops.size();
+    auto builder = HatchObjectBuilder(std::move(loops), std::move(boundaries), angle * M_PI / 180, spacing, rule);
+    registry.CreateObject(builder);
+    output.Writeln("Hatch: " + std::to_string(count) + " loops");
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Dedupe                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+void DedupeCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& output = cad.GetOutput();
+
+    Core::Duration start = Core::Duration::Now();
+    RedundantObjects redundant = FindRedundantObjects(registry);
+    Core::Duration elapsed = Core::Duration::Now() - start;
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    ss << "Duplicates: " << redundant.duplicates.size() << ", overlapped: " << redundant.overlapped.size() << " ("
+       << elapsed.AsMilliseconds() << "ms)";
+    output.Writeln(ss.str());
+
+    auto refs = registry.Find(redundant.duplicates);
+    auto overlapped = registry.Find(redundant.overlapped);
+    refs.insert(refs.end(), overlapped.begin(), overlapped.end());
+    if (remove) {
+        registry.DeleteObjects(refs);
+    } else {
+        registry.Select(refs);
+    }
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                      Measure                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+void MeasureCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& measurements = cad.GetMeasurements();
+
+    Core::Duration start = Core::Duration::Now();
+    const Measurement* measurement = &measurements.Get(registry, MeasurementCache::Scope::Drawing);
+    std::string scope = "Drawing";
+    if (!all) {
+        const Measurement& selection = measurements.Get(registry, MeasurementCache::Scope::Selection);
+        if (selection.count > 0) {
+            measurement = &selection;
+            scope = "Selection";
+        }
+    }
+    Core::Duration elapsed = Core::Duration::Now() - start;
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    ss << scope << ": " << measurement->count << " objects (" << measurement->by_type[size_t(ObjectType::Line)]
+       << " lines, " << measurement->by_type[size_t(ObjectType::Circle)] << " circles, "
+       << measurement->by_type[size_t(ObjectType::Polyline)] << " polylines, "
+       << measurement->by_type[size_t(ObjectType::Insert)] << " inserts, "
+       << measurement->by_type[size_t(ObjectType::Hatch)] << " hatches) (" << elapsed.AsMilliseconds() << "ms)";
+    cad.GetOutput().Writeln(ss.str());
+
+    ss.str("");
+    ss << "Length: " << measurement->length << ", area: " << measurement->area;
+    if (!measurement->extents.IsEmpty()) {
+        auto& extents = measurement->extents;
+        ss << ", extents: [" << extents.min.x << ", " << extents.min.y << "] to [" << extents.max.x << ", "
+           << extents.max.y << "]";
+    }
+    cad.GetOutput().Writeln(ss.str());
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Bench                                                        */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+struct LengthVisitor : public ConstObjectVisitor {
+    float total = 0;
+
+    void Visit(const LineObject& object) override { total += ObjectLength(object); }
+    void Visit(const CircleObject& object) override { total += ObjectLength(object); }
+    void Visit(const PolylineObject& object) override { total += ObjectLength(object); }
+    void Visit(const InsertObject& object) override { total += ObjectLength(object); }
+    void Visit(const HatchObject& object) override { total += ObjectLength(object); }
+};
+
+std::string FormatTiming(std::string label, Core::Duration elapsed, int iterations, float total)
+{
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << label << ": " << elapsed.AsMilliseconds() / iterations << "ms (" << total << ")";
+    return ss.str();
+}
+} // namespace
+
+void BenchCommand::Forward(Cad::Controller& cad)
+{
+    auto& registry = cad.GetRegistry();
+    auto& output = cad.GetOutput();
+    output.Writeln("Objects: " + std::to_string(registry.Count()));
+
+    float total = 0;
+    Core::Duration start = Core::Duration::Now();
+    for (int i = 0; i < iterations; i++) {
+        LengthVisitor visitor;
+        registry.VisitObjects(visitor);
+        total = visitor.total;
+    }
+    output.Writeln(FormatTiming("Visitor", Core::Duration::Now() - start, iterations, total));
+
+    start = Core::Duration::Now();
+    for (int i = 0; i < iterations; i++) {
+        total = 0;
+        registry.Visit([&total](auto& object) { total += ObjectLength(object); });
+    }
+    output.Writeln(FormatTiming("Dispatch", Core::Duration::Now() - start, iterations, total));
+
+    start = Core::Duration::Now();
+    for (int i = 0; i < iterations; i++) {
+        total = 0;
+        for (auto& visitor : registry.ParallelVisitObjects<LengthVisitor>()) {
+            total += visitor.total;
+        }
+    }
+    output.Writeln(FormatTiming("Parallel", Core::Duration::Now() - start, iterations, total));
+
+    // The packed copy is built once up front, the same way a background pass would take it
+    std::vector<ObjectVariant> packed;
+    packed.reserve(registry.Count());
+    registry.Visit([&packed](auto& object) { packed.emplace_back(object); });
+
+    start = Core::Duration::Now();
+    for (int i = 0; i < iterations; i++) {
+        total = 0;
+        for (auto& variant : packed) {
+            total += std::visit([](auto& object) { return ObjectLength(object); }, variant);
+        }
     }
+    output.Writeln(FormatTiming("Variant", Core::Duration::Now() - start, iterations, total));
 }
 
 }; // namespace Cad
\ No newline at end of file
@@ -1,60 +1,22 @@
 #include "cad/Cursor.h"
 namespace Cad {
 
-struct SnapVisitor : public ObjectVisitor {
-    std::vector<SnapVector> snap_vectors;
-    Core::Vector2 mouse_pos;
-    Core::Transform view_transform;
-    float grid_size = 1;
+namespace {
+// Pixels from the cursor a snap point can be, and from the point the candidates were gathered around
+constexpr float SNAP_RADIUS = 10;
+constexpr float CANDIDATE_RADIUS = 40;
 
-    SnapVisitor(Core::Vector2 mouse_pos, Core::Transform view_transform, float grid_size)
-        : mouse_pos(mouse_pos), view_transform(view_transform), grid_size(grid_size)
-    {
-    }
-
-    void Visit(LineObject& object) override
-    {
-        // Check for the midpoint snap condition
-        auto start_screen = view_transform.Apply(object.start);
-        auto end_screen = view_transform.Apply(object.end);
-        auto midpoint_screen = (start_screen + end_screen) / 2;
-        auto distance_from_midpoint = (mouse_pos - midpoint_screen).Length();
-        float grid_screen_size = grid_size * view_transform.scale;
-        if (distance_from_midpoint < 10) {
-            snap_vectors.push_back(SnapVector(midpoint_screen, ReticleType::Midpoint));
-        }
-        // Check for the endpoint snap condition
-        auto distance_from_start = (mouse_pos - start_screen).Length();
-        if (distance_from_start < 10) {
-            snap_vectors.push_back(SnapVector(start_screen, ReticleType::Endpoint));
-        }
-
-        auto distance_from_end = (mouse_pos - end_screen).Length();
-        if (distance_from_end < 10) {
-            snap_vectors.push_back(SnapVector(end_screen, ReticleType::Endpoint));
-        }
-    }
-
-    void Visit(CircleObject& object) override
-    {
-        // Check for the center snap condition
-    }
-
-    void Visit(PolylineObject& object) override
-    {
-        // Check for the midpoint snap condition
-        // Check for the endpoint snap condition
-        // Check for the intersection snap condition
-    }
-
-    std::vector<SnapVector> CollectResults()
-    {
-        // return a vector of SnapVectors
-        auto result = std::move(snap_vectors);
-        snap_vectors.clear();
-        return result;
+ReticleType ReticleOf(SnapIndex::Kind kind)
+{
+    switch (kind) {
+    case SnapIndex::Kind::Endpoint: return ReticleType::Endpoint;
+    case SnapIndex::Kind::Midpoint: return ReticleType::Midpoint;
+    case SnapIndex::Kind::Center: return ReticleType::Center;
+    case SnapIndex::Kind::Quadrant: return ReticleType::Quadrant;
+    default: return ReticleType::None;
     }
-};
+}
+} // namespace
 
 void Cursor::update_mouse_location(Core::Controller& controller)
 {
@@ -75,35 +37,55 @@ void Cursor::snap_cursor_to_grid(Core::Controller& controller, Core::Transform v
     y = snapped_position.y;
 }
 
-void Cursor::collect_snap_vectors(std::vector<SnapVector>& snap_vectors, ObjectRegistry& registry,
-    Core::Transform view_transform, float grid_size)
+void Cursor::collect_snap_candidates(const ObjectRegistry& registry, const SnapIndex& snaps,
+    const IntersectionIndex& intersections, RayBank& ray_bank, const SnapInputs& inputs)
 {
-    SnapVisitor snap_visitor(Core::Vector2(x, y), view_transform, grid_size);
-    registry.VisitObjects(snap_visitor);
-    for (auto vector : snap_visitor.CollectResults()) {
-        snap_vectors.push_back(std::move(vector));
+    candidates.clear();
+    Core::Vector2 query_world = inputs.view_transform.Inverse().Apply(inputs.query);
+    float radius = CANDIDATE_RADIUS / inputs.view_transform.scale;
+    Core::Bounds rect = Core::Bounds(query_world, query_world).Inflated(radius);
+    auto visible = [&](ObjectId id) {
+        return registry.IsAccepted(registry.LayerOf(registry.Find(id)), LayerFilter::Visible);
+    };
+
+    auto nearest = snaps.Nearest(query_world, radius, SIZE_MAX,
+        [&](const SnapIndex::Candidate& candidate) { return visible(candidate.owner); });
+    for (auto& candidate : nearest) {
+        candidates.push_back(SnapCandidate{candidate.point, ReticleOf(candidate.kind)});
+    }
+
+    intersections.Query(rect, [&](const IntersectionIndex::Intersection& intersection) {
+        // Both objects have to be on visible layers for the point to be drawn
+        if (visible(intersection.a) && visible(intersection.b)) {
+            candidates.push_back(SnapCandidate{intersection.point, ReticleType::Intersection});
+        }
+    });
+
+    for (auto point : ray_bank.GetSnapPoints(registry, rect)) {
+        candidates.push_back(SnapCandidate{point, ReticleType::Intersection});
     }
+    candidate_inputs = inputs;
 }
 
-SnapVector Cursor::get_closest_snap_vector(std::vector<SnapVector>& snap_vectors, Core::Vector2 mouse_position)
+SnapVector Cursor::get_closest_snap_vector(const SnapInputs& inputs)
 {
-    // Determine the snap vector with the least distance from the mouse position
-    SnapVector* closest_snap_vector = &snap_vectors[0];
-    int i = 0;
+    // Of the candidates within the snap radius of the query point, take the one closest to the mouse position
+    SnapVector closest_snap_vector(inputs.query, ReticleType::Grid);
     float min_distance = 0;
-    for (auto& vector : snap_vectors) {
-        auto distance = (mouse_position - vector.screen_point).Length();
-        if (distance < min_distance || i == 0) {
+    for (auto& candidate : candidates) {
+        auto screen_point = inputs.view_transform.Apply(candidate.world_point);
+        if ((inputs.query - screen_point).Length() >= SNAP_RADIUS) continue;
+        auto distance = (inputs.mouse - screen_point).Length();
+        if (distance < min_distance || closest_snap_vector.type == ReticleType::Grid) {
             min_distance = distance;
-            closest_snap_vector = &vector;
+            closest_snap_vector = SnapVector(screen_point, candidate.type);
         }
-        i++;
     }
-    return *closest_snap_vector;
+    return closest_snap_vector;
 }
 
 void Cursor::Update(Core::Controller& controller, ObjectRegistry& registry, Core::Transform view_transform,
-    float grid_size, RayBank& ray_bank)
+    float grid_size, RayBank& ray_bank, const SnapIndex& snaps, const IntersectionIndex& intersections)
 {
     // Update x and y to the mouse position, and if grid snapping is enabled, snap to the grid
     update_mouse_location(controller);
@@ -111,32 +93,30 @@ void Cursor::Update(Core::Controller& controller, ObjectRegistry& registry, Core
         snap_cursor_to_grid(controller, view_transform, grid_size);
     }
 
-    // Search for any possible snap vectors
-    std::vector<SnapVector> snap_vectors;
-    collect_snap_vectors(snap_vectors, registry, view_transform, grid_size);
-
-    std::vector<Core::Vector2> snap_points;
-    for (auto vector : ray_bank.GetSnapPoints(registry, view_transform, controller.GetInput().GetMousePosition())) {
-        auto snap_vector = SnapVector(vector, ReticleType::Intersection);
-        snap_vectors.push_back(snap_vector);
+    Core::Vector2 mouse_position = controller.GetInput().GetMousePosition();
+    Core::Vector2 query(x, y);
+    uint64_t revision = registry.GetRevision();
+    uint64_t ray_revision = ray_bank.GetRevision();
+    bool same_scene = last_inputs && last_inputs->SameScene(view_transform, revision, ray_revision);
+    if (!same_scene || !(last_inputs->mouse == mouse_position) || !(last_inputs->query == query)) {
+        SnapInputs inputs{mouse_position, query, view_transform, revision, ray_revision};
+
+        // Gather the candidates again once the mouse could reach a snap outside of them
+        bool candidates_cover = candidate_inputs && candidate_inputs->SameScene(view_transform, revision, ray_revision)
+                                && (query - candidate_inputs->query).Length() <= CANDIDATE_RADIUS - SNAP_RADIUS;
+        if (!candidates_cover) collect_snap_candidates(registry, snaps, intersections, ray_bank, inputs);
+
+        SnapVector snap = get_closest_snap_vector(inputs);
+        if (!reticle || snap.type != last_snap.type) reticle = Reticle::FromType(snap.type);
+        last_snap = snap;
+        last_inputs = std::move(inputs);
     }
 
-    // If no possible snaps, just draw the gridpoint reticle
-    if (snap_vectors.empty()) {
-        std::unique_ptr<GridpointReticle> gridpoint_reticle;
-        gridpoint_reticle = std::make_unique<GridpointReticle>();
-        reticle = std::move(gridpoint_reticle);
-        reticle->Draw(controller, Core::Vector2(x, y));
-    } else {
-        // Otherwise find the closest snap vector to the mouse position and snap to it
-        // Then instantiante the corresponding snap reticle and draw it
-        auto mouse_position = controller.GetInput().GetMousePosition();
-        auto closest_snap_vector = get_closest_snap_vector(snap_vectors, mouse_position);
-        x = closest_snap_vector.screen_point.x;
-        y = closest_snap_vector.screen_point.y;
-        auto reticle = Reticle::FromType(closest_snap_vector.type);
-        reticle->Draw(controller, closest_snap_vector.screen_point);
-    }
+    // Without a snap the gridpoint reticle is drawn at the cursor, otherwise the cursor moves to the snap point and
+    // the reticle of its kind is drawn there
+    x = last_snap.screen_point.x;
+    y = last_snap.screen_point.y;
+    reticle->Draw(controller, last_snap.screen_point);
 
     // Finally draw any raycasts
     // raycast.Draw(controller.GetGraphics(), view_transform);
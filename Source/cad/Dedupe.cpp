@@ -0,0 +1,258 @@
+#include <cad/object/Block.h>
+#include <cad/object/Dedupe.h>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace Cad {
+
+namespace {
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                  Canonical keys                                                    */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+// Sinks for the canonical form of an object, the hasher is used for the parallel pass and the collector to confirm
+// that objects with equal hashes really are equal
+
+struct Hasher {
+    uint64_t hash = 0x9e3779b97f4a7c15ULL;
+
+    void Add(int64_t value) {
+        uint64_t mixed = hash ^ uint64_t(value);
+        mixed ^= mixed >> 33;
+        mixed *= 0xff51afd7ed558ccdULL;
+        mixed ^= mixed >> 33;
+        mixed *= 0xc4ceb9fe1a85ec53ULL;
+        mixed ^= mixed >> 33;
+        hash = mixed;
+    }
+};
+
+struct Collector {
+    std::vector<int64_t> key;
+
+    void Add(int64_t value) { key.push_back(value); }
+};
+
+struct Quantized {
+    int64_t x, y;
+
+    bool operator<(const Quantized& other) const { return x < other.x || (x == other.x && y < other.y); }
+    bool operator==(const Quantized& other) const { return x == other.x && y == other.y; }
+};
+
+int64_t Quantize(float value, float tolerance) { return std::llround(double(value) / tolerance); }
+
+Quantized Quantize(Core::Vector2 point, float tolerance)
+{
+    return Quantized{Quantize(point.x, tolerance), Quantize(point.y, tolerance)};
+}
+
+template <typename Sink> void Add(Sink& sink, Quantized point)
+{
+    sink.Add(point.x);
+    sink.Add(point.y);
+}
+
+template <typename Sink> void Canonical(const LineObject& line, float tolerance, Sink& sink)
+{
+    Quantized a = Quantize(line.start, tolerance);
+    Quantized b = Quantize(line.end, tolerance);
+    if (b < a) std::swap(a, b);
+    Add(sink, a);
+    Add(sink, b);
+}
+
+template <typename Sink> void Canonical(const CircleObject& circle, float tolerance, Sink& sink)
+{
+    Add(sink, Quantize(circle.center, tolerance));
+    sink.Add(Quantize(circle.radius, tolerance));
+}
+
+// A polyline and its reverse are the same geometry, the direction that reads smaller is the canonical one
+template <typename Sink> void Canonical(const PolylineObject& polyline, float tolerance, Sink& sink)
+{
+    auto& points = polyline.points;
+    size_t n = points.size();
+    bool reversed = false;
+    for (size_t i = 0; i < n / 2; i++) {
+        Quantized forward = Quantize(points[i], tolerance);
+        Quantized backward = Quantize(points[n - 1 - i], tolerance);
+        if (forward == backward) continue;
+        reversed = backward < forward;
+        break;
+    }
+
+    sink.Add(int64_t(n));
+    for (size_t i = 0; i < n; i++) {
+        Add(sink, Quantize(points[reversed ? n - 1 - i : i], tolerance));
+    }
+}
+
+template <typename Sink> void Canonical(const InsertObject& insert, float tolerance, Sink& sink)
+{
+    sink.Add(int64_t(reinterpret_cast<uintptr_t>(insert.block.get())));
+    sink.Add(Quantize(insert.transform.x, tolerance));
+    sink.Add(Quantize(insert.transform.y, tolerance));
+    sink.Add(Quantize(insert.transform.scale, tolerance));
+    sink.Add(Quantize(insert.transform.rotation, tolerance));
+}
+
+// Loops are compared in the order they are stored, a hatch traced again from the same objects stores them the same way
+template <typename Sink> void Canonical(const HatchObject& hatch, float tolerance, Sink& sink)
+{
+    sink.Add(int64_t(hatch.rule));
+    sink.Add(Quantize(hatch.angle, tolerance));
+    sink.Add(Quantize(hatch.spacing, tolerance));
+    sink.Add(int64_t(hatch.loops.size()));
+    for (auto& loop : hatch.loops) {
+        sink.Add(int64_t(loop.size()));
+        for (auto& point : loop) {
+            Add(sink, Quantize(point, tolerance));
+        }
+    }
+}
+
+template <typename Sink> void CanonicalObject(const Object& object, float tolerance, Sink& sink)
+{
+    sink.Add(int64_t(object.GetType()));
+    sink.Add(int64_t(object.GetLayer()));
+    Dispatch(object, [tolerance, &sink](auto& concrete) { Canonical(concrete, tolerance, sink); });
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                      Passes                                                        */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+struct HashedObject {
+    uint64_t hash;
+    ObjectId id;
+
+    bool operator<(const HashedObject& other) const {
+        return hash < other.hash || (hash == other.hash && id < other.id);
+    }
+};
+
+struct HashVisitor : public ConstObjectVisitor {
+    const ObjectRegistry& registry;
+    float tolerance;
+    LayerFilter filter;
+    std::vector<HashedObject> hashes;
+
+    HashVisitor(const ObjectRegistry& registry, float tolerance, LayerFilter filter)
+        : registry(registry), tolerance(tolerance), filter(filter) {}
+
+    void Add(const Object& object) {
+        if (!registry.IsAccepted(object.GetLayer(), filter)) return;
+        Hasher hasher;
+        CanonicalObject(object, tolerance, hasher);
+        hashes.push_back(HashedObject{hasher.hash, object.GetId()});
+    }
+
+    void Visit(const LineObject& object) override { Add(object); }
+    void Visit(const CircleObject& object) override { Add(object); }
+    void Visit(const PolylineObject& object) override { Add(object); }
+    void Visit(const InsertObject& object) override { Add(object); }
+    void Visit(const HatchObject& object) override { Add(object); }
+};
+
+// True if the segment lies on the line through the cover and between its ends, within the tolerance
+bool Covers(const LineObject& cover, const LineObject& segment, float tolerance)
+{
+    Core::Vector2 direction = cover.end - cover.start;
+    float length = direction.Length();
+    if (length <= tolerance) return false;
+    direction = direction / length;
+
+    for (Core::Vector2 point : {segment.start, segment.end}) {
+        Core::Vector2 offset = point - cover.start;
+        if (std::abs(direction.Cross(offset)) > tolerance) return false;
+        float along = direction.Dot(offset);
+        if (along < -tolerance || along > length + tolerance) return false;
+    }
+    return true;
+}
+
+struct OverlapVisitor : public ConstObjectVisitor {
+    const ObjectRegistry& registry;
+    float tolerance;
+    LayerFilter filter;
+    std::vector<ObjectId> overlapped;
+
+    OverlapVisitor(const ObjectRegistry& registry, float tolerance, LayerFilter filter)
+        : registry(registry), tolerance(tolerance), filter(filter) {}
+
+    // Every line reports the lines it covers. Two lines that cover each other are the same segment, the newer one
+    // is reported.
+    void Visit(const LineObject& line) override {
+        if (!registry.IsAccepted(line.GetLayer(), filter)) return;
+        registry.Visit(line.GetBounds().Inflated(tolerance), filter, [this, &line](auto& other) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(other)>, LineObject>) {
+                if (&other == &line || other.GetLayer() != line.GetLayer()) return;
+                if (!Covers(line, other, tolerance)) return;
+                if (Covers(other, line, tolerance) && other.GetId() < line.GetId()) return;
+                overlapped.push_back(other.GetId());
+            }
+        });
+    }
+
+    void Visit(const CircleObject&) override {}
+    void Visit(const PolylineObject&) override {}
+    void Visit(const InsertObject&) override {}
+    void Visit(const HatchObject&) override {}
+};
+
+std::vector<int64_t> CanonicalKey(const ObjectRegistry& registry, ObjectId id, float tolerance)
+{
+    Collector collector;
+    registry.Visit(std::vector<ObjectRegistry::Reference>{registry.Find(id)},
+        [tolerance, &collector](auto& object) { CanonicalObject(object, tolerance, collector); });
+    return collector.key;
+}
+
+} // namespace
+
+RedundantObjects FindRedundantObjects(const ObjectRegistry& registry, float tolerance, LayerFilter filter)
+{
+    RedundantObjects result;
+
+    // Hash every object in parallel, then sort so that equal geometry ends up adjacent with the oldest object first
+    std::vector<HashedObject> hashes;
+    hashes.reserve(registry.Count());
+    for (auto& visitor : registry.ParallelVisitObjects<HashVisitor>(registry, tolerance, filter)) {
+        hashes.insert(hashes.end(), visitor.hashes.begin(), visitor.hashes.end());
+    }
+    std::sort(hashes.begin(), hashes.end());
+
+    for (size_t first = 0, next; first < hashes.size(); first = next) {
+        next = first + 1;
+        while (next < hashes.size() && hashes[next].hash == hashes[first].hash) {
+            next++;
+        }
+        if (next - first == 1) continue;
+
+        // Equal hashes are confirmed against the full key before anything is called a duplicate
+        auto key = CanonicalKey(registry, hashes[first].id, tolerance);
+        for (size_t i = first + 1; i < next; i++) {
+            if (CanonicalKey(registry, hashes[i].id, tolerance) == key) result.duplicates.push_back(hashes[i].id);
+        }
+    }
+
+    std::vector<ObjectId> overlapped;
+    for (auto& visitor : registry.ParallelVisitObjects<OverlapVisitor>(registry, tolerance, filter)) {
+        overlapped.insert(overlapped.end(), visitor.overlapped.begin(), visitor.overlapped.end());
+    }
+    std::sort(overlapped.begin(), overlapped.end());
+    overlapped.erase(std::unique(overlapped.begin(), overlapped.end()), overlapped.end());
+
+    // Exact duplicates of lines cover each other as well, they are only reported once
+    std::vector<ObjectId> duplicates = result.duplicates;
+    std::sort(duplicates.begin(), duplicates.end());
+    std::set_difference(overlapped.begin(), overlapped.end(), duplicates.begin(), duplicates.end(),
+        std::back_inserter(result.overlapped));
+    return result;
+}
+
+} // namespace Cad
@@ -0,0 +1,521 @@
+#include <cad/object/Edit.h>
+#include <cad/object/IntersectionIndex.h>
+#include <core/math/Geometry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+
+namespace Cad {
+
+namespace {
+
+using Primitive = IntersectionIndex::Primitive;
+
+// Cuts closer than this to each other or to an end of the path, in path parameter, are the same place
+constexpr double PARAMETER_EPSILON = 1e-6;
+// Largest angle an arc left over from a circle turns through per segment
+constexpr double ARC_STEP = M_PI / 36;
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Paths                                                        */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+// A line, polyline or circle as a path parametrized from 0 to Length(). Segment i of a polyline covers [i, i + 1],
+// a line is a polyline of one segment and a circle goes counterclockwise from angle 0 to 2 pi.
+struct Path {
+    enum class Kind {
+        Line,
+        Polyline,
+        Circle,
+    };
+
+    Kind kind;
+    std::vector<Core::Vector2> points;
+    Core::Vector2 center;
+    float radius = 0;
+    bool closed = false;
+
+    double Length() const { return kind == Kind::Circle ? 2 * M_PI : double(points.size() - 1); }
+
+    Core::Vector2 At(double s) const {
+        if (closed) {
+            s = std::fmod(s, Length());
+            if (s < 0) s += Length();
+        }
+        if (kind == Kind::Circle) {
+            return Core::Vector2(center.x + radius * std::cos(s), center.y + radius * std::sin(s));
+        }
+        size_t i = std::min(size_t(std::max(s, 0.0)), points.size() - 2);
+        double t = s - i;
+        Core::Vector2 a = points[i], b = points[i + 1];
+        return Core::Vector2(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t);
+    }
+
+    // Parameter of the point of segment i (or of the circle) closest to the point
+    double ParameterOn(size_t segment, Core::Vector2 point) const {
+        if (kind == Kind::Circle) {
+            double angle = std::atan2(double(point.y) - center.y, double(point.x) - center.x);
+            return angle < 0 ? angle + 2 * M_PI : angle;
+        }
+        Core::Vector2 a = points[segment], direction = points[segment + 1] - a;
+        double length2 = double(direction.x) * direction.x + double(direction.y) * direction.y;
+        if (length2 == 0) return double(segment);
+        double t = (double(point.x - a.x) * direction.x + double(point.y - a.y) * direction.y) / length2;
+        return segment + std::clamp(t, 0.0, 1.0);
+    }
+
+    double Project(Core::Vector2 point) const {
+        if (kind == Kind::Circle) return ParameterOn(0, point);
+        double best = 0;
+        float best_distance = INFINITY;
+        for (size_t i = 0; i + 1 < points.size(); i++) {
+            float distance = Core::DistanceToSegment(point, points[i], points[i + 1]);
+            if (distance >= best_distance) continue;
+            best_distance = distance;
+            best = ParameterOn(i, point);
+        }
+        return best;
+    }
+
+    // The part of the path from u to v, which may go past the end of a closed path and round again
+    std::unique_ptr<Object> Piece(double u, double v) const {
+        if (kind == Kind::Line) return std::make_unique<LineObject>(At(u), At(v));
+        VertexList vertices;
+        vertices.push_back(At(u));
+        if (kind == Kind::Circle) {
+            int steps = std::max(1, int(std::ceil((v - u) / ARC_STEP)));
+            for (int k = 1; k < steps; k++) {
+                vertices.push_back(At(u + (v - u) * k / steps));
+            }
+        } else {
+            for (double s = std::floor(u) + 1; s < v - PARAMETER_EPSILON; s++) {
+                if (s > u + PARAMETER_EPSILON) vertices.push_back(At(s));
+            }
+        }
+        vertices.push_back(At(v));
+        return std::make_unique<PolylineObject>(std::move(vertices));
+    }
+};
+
+std::optional<Path> MakePath(const Object& object)
+{
+    return Dispatch(object, [](auto& concrete) -> std::optional<Path> {
+        using T = std::decay_t<decltype(concrete)>;
+        Path path;
+        if constexpr (std::is_same_v<T, LineObject>) {
+            path.kind = Path::Kind::Line;
+            path.points = {concrete.start, concrete.end};
+        } else if constexpr (std::is_same_v<T, PolylineObject>) {
+            if (concrete.points.size() < 2) return std::nullopt;
+            path.kind = Path::Kind::Polyline;
+            path.points.assign(concrete.points.begin(), concrete.points.end());
+            path.closed = path.points.size() > 3 && path.points.front() == path.points.back();
+        } else if constexpr (std::is_same_v<T, CircleObject>) {
+            path.kind = Path::Kind::Circle;
+            path.center = concrete.center;
+            path.radius = concrete.radius;
+            path.closed = true;
+        } else {
+            return std::nullopt;
+        }
+        return path;
+    });
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                      Boundaries                                                    */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+// Primitives of the visible objects whose bounds the query reaches, other than the object being edited. A boundary
+// the query finds again for another segment of the same path is only broken down once.
+class Boundaries {
+    const ObjectRegistry& registry;
+    ObjectId self;
+    std::unordered_map<ObjectId, std::vector<Primitive>> primitives;
+
+    template <typename F> auto Collect(F&& function) {
+        return [this, &function](auto& object) {
+            if (object.GetId() == self) return;
+            auto found = primitives.find(object.GetId());
+            if (found == primitives.end()) {
+                found = primitives.emplace(object.GetId(), std::vector<Primitive>()).first;
+                IntersectionIndex::Decompose(object, found->second);
+            }
+            for (auto& primitive : found->second) {
+                function(primitive);
+            }
+        };
+    }
+
+  public:
+    Boundaries(const ObjectRegistry& registry, ObjectId self) : registry(registry), self(self) {}
+
+    template <typename F> void Along(Core::Vector2 a, Core::Vector2 b, F&& function) {
+        registry.Visit(a, b, LayerFilter::Visible, Collect(function));
+    }
+
+    template <typename F> void Within(const Core::Bounds& rect, F&& function) {
+        registry.Visit(rect, LayerFilter::Visible, Collect(function));
+    }
+};
+
+// Where the segment meets the primitive
+Core::Intersections Intersect(Core::Vector2 a, Core::Vector2 b, const Primitive& primitive)
+{
+    if (primitive.kind == Primitive::Kind::Circle) {
+        return Core::IntersectSegmentCircle(a, b, primitive.a, primitive.radius);
+    }
+    return Core::IntersectSegments(a, b, primitive.a, primitive.b);
+}
+
+// Parameters where other objects cross the path, sorted, with cuts at the same place merged and cuts at the ends of an
+// open path dropped
+std::vector<double> FindCuts(const ObjectRegistry& registry, const Path& path, ObjectId self)
+{
+    std::vector<double> found;
+    Boundaries boundaries(registry, self);
+    if (path.kind == Path::Kind::Circle) {
+        Core::Bounds rect(path.center - path.radius, path.center + path.radius);
+        boundaries.Within(rect, [&path, &found](const Primitive& primitive) {
+            Core::Intersections hits =
+                primitive.kind == Primitive::Kind::Circle
+                    ? Core::IntersectCircles(path.center, path.radius, primitive.a, primitive.radius)
+                    : Core::IntersectSegmentCircle(primitive.a, primitive.b, path.center, path.radius);
+            for (int k = 0; k < hits.count; k++) {
+                found.push_back(path.ParameterOn(0, hits.points[k]));
+            }
+        });
+    } else {
+        for (size_t i = 0; i + 1 < path.points.size(); i++) {
+            Core::Vector2 a = path.points[i], b = path.points[i + 1];
+            boundaries.Along(a, b, [&path, &found, i, a, b](const Primitive& primitive) {
+                Core::Intersections hits = Intersect(a, b, primitive);
+                for (int k = 0; k < hits.count; k++) {
+                    found.push_back(path.ParameterOn(i, hits.points[k]));
+                }
+            });
+        }
+    }
+
+    std::sort(found.begin(), found.end());
+    double length = path.Length();
+    std::vector<double> cuts;
+    for (double cut : found) {
+        if (!path.closed && (cut < PARAMETER_EPSILON || cut > length - PARAMETER_EPSILON)) continue;
+        if (!cuts.empty() && cut - cuts.back() < PARAMETER_EPSILON) continue;
+        cuts.push_back(cut);
+    }
+    if (path.closed && cuts.size() > 1 && cuts.front() + length - cuts.back() < PARAMETER_EPSILON) cuts.pop_back();
+    return cuts;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                      Writing                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+// What an edit does to one object. Replacing puts the first new object in the object's place and adds the rest to
+// its layer, with no objects the object is deleted. Otherwise the new objects are only added.
+struct Rewrite {
+    ObjectId id;
+    bool replace;
+    std::vector<std::unique_ptr<Object>> objects;
+};
+
+// Write every rewrite as one change. New objects are created a layer at a time in bulk.
+void Apply(ObjectRegistry& registry, const char* label, std::vector<Rewrite>& rewrites)
+{
+    std::vector<ObjectRegistry::Reference> removed;
+    std::map<LayerId, std::vector<std::unique_ptr<Object>>> created;
+    registry.BeginChange(label);
+    for (auto& rewrite : rewrites) {
+        ObjectRegistry::Reference reference = registry.Find(rewrite.id);
+        if (reference->NotValid()) continue;
+        auto& added = created[registry.LayerOf(reference)];
+        size_t first = 0;
+        if (rewrite.replace && rewrite.objects.empty()) {
+            removed.push_back(reference);
+        } else if (rewrite.replace) {
+            registry.ReplaceObject(reference, std::move(rewrite.objects[0]));
+            first = 1;
+        }
+        for (size_t i = first; i < rewrite.objects.size(); i++) {
+            added.push_back(std::move(rewrite.objects[i]));
+        }
+    }
+    registry.DeleteObjects(std::move(removed));
+
+    LayerId current = registry.GetCurrentLayer();
+    for (auto& [layer, objects] : created) {
+        if (objects.empty()) continue;
+        registry.SetCurrentLayer(layer);
+        registry.CreateObjects(std::move(objects));
+    }
+    registry.SetCurrentLayer(current);
+    registry.EndChange();
+}
+
+// The path of an editable object, none for objects that can't be edited this way
+std::optional<Path> EditablePath(const ObjectRegistry& registry, const ObjectRegistry::Reference& reference)
+{
+    if (reference->NotValid() || !registry.IsAccepted(registry.LayerOf(reference), LayerFilter::Editable)) {
+        return std::nullopt;
+    }
+    std::optional<Path> path;
+    registry.Visit({reference}, [&path](auto& object) { path = MakePath(object); });
+    return path;
+}
+
+} // namespace
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                        Trim                                                        */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+
+// The parameter ranges left of the path once the spans between neighbouring cuts that hold a pick are taken out, with
+// neighbouring spans that both stay joined up again
+std::vector<std::pair<double, double>> Remaining(
+    const Path& path, const std::vector<double>& cuts, const std::vector<double>& picks)
+{
+    double length = path.Length();
+    std::vector<std::pair<double, double>> spans;
+    if (!path.closed) {
+        double start = 0;
+        for (double cut : cuts) {
+            spans.emplace_back(start, cut);
+            start = cut;
+        }
+        spans.emplace_back(start, length);
+    } else if (cuts.size() > 1) {
+        for (size_t j = 0; j < cuts.size(); j++) {
+            spans.emplace_back(cuts[j], j + 1 < cuts.size() ? cuts[j + 1] : cuts[0] + length);
+        }
+    } else {
+        return {};
+    }
+
+    std::vector<bool> removed(spans.size(), false);
+    for (double pick : picks) {
+        size_t j = std::upper_bound(cuts.begin(), cuts.end(), pick) - cuts.begin();
+        // On a closed path the span before the first cut is the one that wraps round from the last
+        if (path.closed) j = j == 0 ? cuts.size() : j;
+        removed[j - (path.closed ? 1 : 0)] = true;
+    }
+
+    // Start right after a removed span, so that on a closed path no kept run is split where the parameter wraps
+    size_t count = spans.size();
+    size_t first = 0;
+    if (path.closed) {
+        while (!removed[first]) first++;
+        first++;
+    }
+    std::vector<std::pair<double, double>> ranges;
+    bool joined = false;
+    for (size_t m = 0; m < count; m++) {
+        size_t j = (first + m) % count;
+        if (removed[j]) {
+            joined = false;
+            continue;
+        }
+        double offset = path.closed && first + m >= count ? length : 0;
+        std::pair<double, double> span(spans[j].first + offset, spans[j].second + offset);
+        if (joined) {
+            ranges.back().second = span.second;
+        } else {
+            ranges.push_back(span);
+        }
+        joined = true;
+    }
+    return ranges;
+}
+
+} // namespace
+
+size_t TrimObjects(ObjectRegistry& registry, const std::vector<TrimPick>& picks)
+{
+    // Picks on the same object take their pieces out of it together, objects in the order they were first picked
+    std::vector<ObjectId> order;
+    std::vector<std::vector<Core::Vector2>> points;
+    IdIndex<size_t> groups;
+    for (auto& pick : picks) {
+        const size_t* group = groups.Find(pick.id);
+        if (group == nullptr) {
+            groups.Insert(pick.id, order.size());
+            order.push_back(pick.id);
+            points.emplace_back();
+            group = groups.Find(pick.id);
+        }
+        points[*group].push_back(pick.point);
+    }
+
+    std::vector<Rewrite> rewrites;
+    for (size_t g = 0; g < order.size(); g++) {
+        std::optional<Path> path = EditablePath(registry, registry.Find(order[g]));
+        if (!path) continue;
+        std::vector<double> cuts = FindCuts(registry, *path, order[g]);
+        std::vector<double> parameters;
+        for (Core::Vector2 point : points[g]) {
+            parameters.push_back(path->Project(point));
+        }
+
+        Rewrite rewrite{order[g], true, {}};
+        for (auto [u, v] : Remaining(*path, cuts, parameters)) {
+            if (v - u > PARAMETER_EPSILON) rewrite.objects.push_back(path->Piece(u, v));
+        }
+        rewrites.push_back(std::move(rewrite));
+    }
+    Apply(registry, "trim", rewrites);
+    return rewrites.size();
+}
+
+std::vector<TrimPick> FencePicks(const ObjectRegistry& registry, Core::Vector2 a, Core::Vector2 b)
+{
+    std::vector<TrimPick> picks;
+    std::vector<Primitive> primitives;
+    registry.Visit(a, b, LayerFilter::Editable, [&picks, &primitives, a, b](auto& object) {
+        if constexpr (!std::is_same_v<std::decay_t<decltype(object)>, InsertObject>) {
+            primitives.clear();
+            IntersectionIndex::Decompose(object, primitives);
+            for (auto& primitive : primitives) {
+                Core::Intersections hits = Intersect(a, b, primitive);
+                for (int k = 0; k < hits.count; k++) {
+                    picks.push_back(TrimPick{object.GetId(), hits.points[k]});
+                }
+            }
+        }
+    });
+    return picks;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Extend                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+
+// Move the end of the segment coming from behind forward to the nearest boundary, if the ray from it meets one before
+// it has crossed the whole drawing
+bool ExtendEnd(const ObjectRegistry& registry, const Core::Bounds& drawing, ObjectId self, Core::Vector2 behind,
+    Core::Vector2& end)
+{
+    Core::Vector2 direction = end - behind;
+    if (direction.Length() == 0) return false;
+    direction = direction.Normalized();
+    Core::Vector2 far = end + direction * (drawing.GetSize().Length() + (end - drawing.GetCenter()).Length());
+
+    // Boundaries that only touch the end, such as the next object of a chain, are not ahead of it
+    float epsilon = 1e-5f * (1 + std::max(std::abs(end.x), std::abs(end.y)));
+    float nearest = INFINITY;
+    Core::Vector2 target = end;
+    Boundaries(registry, self).Along(end, far, [&](const Primitive& primitive) {
+        Core::Intersections hits = Intersect(end, far, primitive);
+        for (int k = 0; k < hits.count; k++) {
+            float distance = (hits.points[k] - end).Dot(direction);
+            if (distance <= epsilon || distance >= nearest) continue;
+            nearest = distance;
+            target = hits.points[k];
+        }
+    });
+    if (nearest == INFINITY) return false;
+    end = target;
+    return true;
+}
+
+} // namespace
+
+size_t ExtendObjects(ObjectRegistry& registry, const std::vector<ObjectId>& ids, std::optional<Core::Vector2> toward)
+{
+    Core::Bounds drawing = registry.GetBounds(LayerFilter::Visible);
+    std::vector<Rewrite> rewrites;
+    for (ObjectId id : ids) {
+        std::optional<Path> path = EditablePath(registry, registry.Find(id));
+        if (!path || path->kind == Path::Kind::Circle || path->closed) continue;
+
+        auto& points = path->points;
+        bool start = true, end = true;
+        if (toward) {
+            start = (points.front() - *toward).Length() < (points.back() - *toward).Length();
+            end = !start;
+        }
+        bool extended = false;
+        size_t last = points.size() - 1;
+        if (start) extended |= ExtendEnd(registry, drawing, id, points[1], points[0]);
+        if (end) extended |= ExtendEnd(registry, drawing, id, points[last - 1], points[last]);
+        if (!extended) continue;
+        rewrites.push_back(Rewrite{id, true, {}});
+        rewrites.back().objects.push_back(path->Piece(0, path->Length()));
+    }
+    Apply(registry, "extend", rewrites);
+    return rewrites.size();
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Offset                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+
+Core::Vector2 Normal(Core::Vector2 direction)
+{
+    return Core::Vector2(-direction.y, direction.x).Normalized();
+}
+
+// Offset polyline with each corner where the offset segments on either side of it meet, or where the next segment
+// starts if they are parallel
+std::unique_ptr<Object> OffsetPath(const Path& path, float distance)
+{
+    std::vector<Core::Vector2> points;
+    for (Core::Vector2 point : path.points) {
+        if (points.empty() || !(points.back() == point)) points.push_back(point);
+    }
+    if (points.size() < 2) return nullptr;
+
+    size_t segments = points.size() - 1;
+    std::vector<Core::Vector2> starts, directions;
+    for (size_t i = 0; i < segments; i++) {
+        directions.push_back(points[i + 1] - points[i]);
+        starts.push_back(points[i] + Normal(directions[i]) * distance);
+    }
+    auto corner = [&](size_t before, size_t after) {
+        Core::Intersections meet =
+            Core::IntersectLines(starts[before], directions[before], starts[after], directions[after]);
+        return meet.count > 0 ? meet.points[0] : starts[after];
+    };
+
+    VertexList vertices;
+    vertices.push_back(path.closed && segments > 1 ? corner(segments - 1, 0) : starts[0]);
+    for (size_t i = 1; i < segments; i++) {
+        vertices.push_back(corner(i - 1, i));
+    }
+    vertices.push_back(path.closed && segments > 1 ? vertices.front() : starts.back() + directions.back());
+    if (path.kind == Path::Kind::Line) return std::make_unique<LineObject>(vertices.front(), vertices.back());
+    return std::make_unique<PolylineObject>(std::move(vertices));
+}
+
+} // namespace
+
+size_t OffsetObjects(ObjectRegistry& registry, const std::vector<ObjectId>& ids, float distance)
+{
+    std::vector<Rewrite> rewrites;
+    for (ObjectId id : ids) {
+        std::optional<Path> path = EditablePath(registry, registry.Find(id));
+        if (!path) continue;
+        std::unique_ptr<Object> copy;
+        if (path->kind != Path::Kind::Circle) {
+            copy = OffsetPath(*path, distance);
+        } else if (path->radius + distance > 0) {
+            copy = std::make_unique<CircleObject>(path->center, path->radius + distance);
+        }
+        if (copy == nullptr) continue;
+        rewrites.push_back(Rewrite{id, false, {}});
+        rewrites.back().objects.push_back(std::move(copy));
+    }
+    Apply(registry, "offset", rewrites);
+    return rewrites.size();
+}
+
+} // namespace Cad
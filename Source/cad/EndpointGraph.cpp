@@ -0,0 +1,170 @@
+#include <cad/object/EndpointGraph.h>
+
+#include <cmath>
+#include <unordered_set>
+
+namespace Cad {
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    Maintenance                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+EndpointGraph::Cell EndpointGraph::CellOf(Core::Vector2 point) const
+{
+    return Cell{int64_t(std::floor(point.x / tolerance)), int64_t(std::floor(point.y / tolerance))};
+}
+
+bool EndpointGraph::GetEnds(const Object& object, Core::Vector2& start, Core::Vector2& end)
+{
+    switch (object.GetType()) {
+    case ObjectType::Line: {
+        auto& line = static_cast<const LineObject&>(object);
+        start = line.start;
+        end = line.end;
+        return true;
+    }
+    case ObjectType::Polyline: {
+        auto& polyline = static_cast<const PolylineObject&>(object);
+        if (polyline.points.size() < 2) return false;
+        start = polyline.points.front();
+        end = polyline.points.back();
+        return true;
+    }
+    default: return false;
+    }
+}
+
+void EndpointGraph::Add(const Object& object)
+{
+    Ends ends;
+    if (!GetEnds(object, ends.points[0], ends.points[1])) return;
+    for (int side = 0; side < 2; side++) {
+        cells[CellOf(ends.points[side])].push_back(End{object.GetId(), side, ends.points[side]});
+    }
+    objects.Insert(object.GetId(), ends);
+}
+
+void EndpointGraph::Remove(ObjectId id)
+{
+    const Ends* ends = objects.Find(id);
+    if (ends == nullptr) return;
+    for (int side = 0; side < 2; side++) {
+        auto cell = cells.find(CellOf(ends->points[side]));
+        if (cell == cells.end()) continue;
+        auto& list = cell->second;
+        for (size_t i = 0; i < list.size(); i++) {
+            if (list[i].id != id || list[i].side != side) continue;
+            list[i] = list.back();
+            list.pop_back();
+            break;
+        }
+        if (list.empty()) cells.erase(cell);
+    }
+    objects.Remove(id);
+}
+
+void EndpointGraph::Rebuild(const ObjectRegistry& registry)
+{
+    cells.clear();
+    objects.Clear();
+    objects.Reserve(registry.Count());
+    registry.Visit([this](auto& object) { Add(object); });
+}
+
+void EndpointGraph::Sync(const ObjectRegistry& registry)
+{
+    auto& journal = registry.GetJournal();
+    if (!synced) {
+        cursor = journal.GetCursor();
+        Rebuild(registry);
+        synced = true;
+        return;
+    }
+
+    // Re-adding reads the object as it is now, so replaying several records for the same object is harmless
+    bool complete = journal.Read(cursor, [this, &registry](const ObjectRegistry::Journal::Record& record) {
+        Remove(record.handle);
+        if (record.type == ObjectRegistry::Journal::Type::Deleted) return;
+        auto reference = registry.Find(record.handle);
+        if (reference->NotValid()) return;
+        registry.Visit(std::vector<ObjectRegistry::Reference>{reference}, [this](auto& object) { Add(object); });
+    });
+    if (!complete) Rebuild(registry);
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                      Queries                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+std::vector<EndpointGraph::End> EndpointGraph::EndsAt(Core::Vector2 point) const
+{
+    std::vector<End> result;
+    Cell center = CellOf(point);
+    for (int64_t x = center.x - 1; x <= center.x + 1; x++) {
+        for (int64_t y = center.y - 1; y <= center.y + 1; y++) {
+            auto cell = cells.find(Cell{x, y});
+            if (cell == cells.end()) continue;
+            for (const End& end : cell->second) {
+                if ((end.point - point).Length() <= tolerance) result.push_back(end);
+            }
+        }
+    }
+    return result;
+}
+
+const EndpointGraph::End* EndpointGraph::Continuation(
+    const End& end, const std::function<bool(ObjectId)>& accept, std::vector<End>& scratch) const
+{
+    scratch = EndsAt(end.point);
+    if (scratch.size() != 2) return nullptr;
+    const End& other = scratch[0].id == end.id && scratch[0].side == end.side ? scratch[1] : scratch[0];
+    if (other.id == end.id && other.side == end.side) return nullptr;
+    if (accept && !accept(other.id)) return nullptr;
+    return &other;
+}
+
+std::vector<EndpointGraph::Link> EndpointGraph::Chain(ObjectId seed, const std::function<bool(ObjectId)>& accept) const
+{
+    const Ends* seed_ends = objects.Find(seed);
+    if (seed_ends == nullptr) return {};
+
+    std::unordered_set<ObjectId> visited{seed};
+    std::vector<End> scratch;
+
+    // Walk forward out of the seed's end, then backward out of its start
+    std::vector<Link> forward{Link{seed, false}};
+    End current{seed, 1, seed_ends->points[1]};
+    while (const End* next = Continuation(current, accept, scratch)) {
+        if (!visited.insert(next->id).second) break;
+        forward.push_back(Link{next->id, next->side == 1});
+        int exit = 1 - next->side;
+        current = End{next->id, exit, objects.Find(next->id)->points[exit]};
+    }
+
+    std::vector<Link> backward;
+    current = End{seed, 0, seed_ends->points[0]};
+    while (const End* next = Continuation(current, accept, scratch)) {
+        if (!visited.insert(next->id).second) break;
+        // Walking backward the object is entered at the end the chain later leaves it from
+        backward.push_back(Link{next->id, next->side == 0});
+        int exit = 1 - next->side;
+        current = End{next->id, exit, objects.Find(next->id)->points[exit]};
+    }
+
+    std::vector<Link> chain(backward.rbegin(), backward.rend());
+    chain.insert(chain.end(), forward.begin(), forward.end());
+    return chain;
+}
+
+std::vector<EndpointGraph::End> EndpointGraph::OpenEnds() const
+{
+    std::vector<End> result;
+    for (auto& [cell, ends] : cells) {
+        for (const End& end : ends) {
+            if (EndsAt(end.point).size() == 1) result.push_back(end);
+        }
+    }
+    return result;
+}
+
+} // namespace Cad
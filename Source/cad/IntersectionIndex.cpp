@@ -0,0 +1,626 @@
+#include <cad/object/IntersectionIndex.h>
+
+#include <core/math/Geometry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <tuple>
+#include <unordered_set>
+
+namespace Cad {
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                   Decomposition                                                    */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+
+using Primitive = IntersectionIndex::Primitive;
+
+void AddSegment(Core::Vector2 a, Core::Vector2 b, ObjectId owner, std::vector<Primitive>& primitives)
+{
+    primitives.push_back(Primitive{Primitive::Kind::Segment, a, b, 0, owner});
+}
+
+void Decompose(const LineObject& line, const Core::Transform& transform, ObjectId owner, std::vector<Primitive>& out)
+{
+    AddSegment(transform.Apply(line.start), transform.Apply(line.end), owner, out);
+}
+
+void Decompose(
+    const CircleObject& circle, const Core::Transform& transform, ObjectId owner, std::vector<Primitive>& out)
+{
+    Core::Vector2 center = transform.Apply(circle.center);
+    out.push_back(Primitive{Primitive::Kind::Circle, center, center, circle.radius * transform.scale, owner});
+}
+
+void Decompose(
+    const PolylineObject& polyline, const Core::Transform& transform, ObjectId owner, std::vector<Primitive>& out)
+{
+    for (size_t i = 1; i < polyline.points.size(); i++) {
+        AddSegment(transform.Apply(polyline.points[i - 1]), transform.Apply(polyline.points[i]), owner, out);
+    }
+}
+
+// The outline of a hatch is the objects it was traced from, which take part on their own
+void Decompose(const HatchObject&, const Core::Transform&, ObjectId, std::vector<Primitive>&)
+{
+}
+
+void Decompose(
+    const InsertObject& insert, const Core::Transform& transform, ObjectId owner, std::vector<Primitive>& out)
+{
+    Core::Transform placement = transform * insert.transform;
+    insert.block->Visit([&placement, owner, &out](auto& object) { Decompose(object, placement, owner, out); });
+}
+
+} // namespace
+
+void IntersectionIndex::Decompose(const Object& object, std::vector<Primitive>& primitives)
+{
+    Dispatch(object, [&object, &primitives](auto& concrete) {
+        Cad::Decompose(concrete, Core::Transform::Identity(), object.GetId(), primitives);
+    });
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Sweep                                                        */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+
+// Sweeps a vertical line from left to right over x-monotone curves (the segments, and the upper and lower half of
+// every circle), keeping the curves it currently crosses ordered bottom to top. Intersections can only happen between
+// curves that are neighbours in that order, so only new neighbours are tested, and the intersections found to the
+// right of the line are queued as events of their own. Points where several curves meet are handled as one event,
+// the way de Berg et al. describe it, which also takes care of vertical segments.
+class Sweeper {
+    struct Point {
+        double x, y;
+    };
+
+    struct Curve {
+        uint32_t primitive;
+        // 0 for a segment, 1 for the upper half of a circle and -1 for the lower half
+        int half;
+        // Lexicographically smaller and larger end
+        Point left, right;
+        bool vertical;
+    };
+
+    // Event positions are snapped to a grid of the tolerance, so the queue has a strict order and points closer than
+    // the tolerance are one event
+    struct Key {
+        int64_t x, y;
+        bool operator<(const Key& other) const { return x < other.x || (x == other.x && y < other.y); }
+        bool operator==(const Key& other) const { return x == other.x && y == other.y; }
+    };
+
+    // Order of two curves held for the rest of a column
+    struct Hold {
+        uint32_t lower, upper;
+        // Already reported as meeting in the column
+        bool crossed;
+    };
+
+    struct Event {
+        Point point;
+        std::vector<uint32_t> starts, ends;
+    };
+
+    // Stands for the event point itself in status searches, ordered before every curve that passes through it
+    static constexpr uint32_t PROBE = std::numeric_limits<uint32_t>::max();
+
+    struct StatusLess {
+        const Sweeper* sweeper;
+        bool operator()(uint32_t a, uint32_t b) const { return sweeper->Below(a, b); }
+    };
+
+    using Status = std::set<uint32_t, StatusLess>;
+
+    const std::vector<Primitive>& primitives;
+    double tolerance;
+    std::vector<Curve> curves;
+    std::map<Key, Event> queue;
+    Point sweep;
+    Status status;
+    std::vector<Status::iterator> positions;
+    // Curves through the current event point, which take its y while they are put back in order
+    std::vector<bool> at_event;
+    // Pairs whose order in the current column is held rather than read off the sweep line: steep curves put in order
+    // at an event point, and pairs found crossing after the sweep had passed their crossing. Right of the column they
+    // are in that order on their own.
+    std::vector<Hold> held;
+    int64_t column = std::numeric_limits<int64_t>::min();
+    std::vector<IntersectionIndex::Crossing> crossings;
+
+    Key KeyOf(Point point) const {
+        return Key{std::llround(point.x / tolerance), std::llround(point.y / tolerance)};
+    }
+
+    double YAt(uint32_t index, double x) const {
+        if (index == PROBE || at_event[index]) return sweep.y;
+        const Curve& curve = curves[index];
+        if (curve.half == 0) {
+            // A vertical segment is wherever the event point is along it
+            if (curve.vertical) return std::clamp(sweep.y, curve.left.y, curve.right.y);
+            if (x <= curve.left.x) return curve.left.y;
+            if (x >= curve.right.x) return curve.right.y;
+            return curve.left.y + (x - curve.left.x) * (curve.right.y - curve.left.y) / (curve.right.x - curve.left.x);
+        }
+        const Primitive& circle = primitives[curve.primitive];
+        double radius = circle.radius;
+        double dx = std::clamp(x - circle.a.x, -radius, radius);
+        return circle.a.y + curve.half * std::sqrt(std::max(0.0, radius * radius - dx * dx));
+    }
+
+    // Direction the curve leaves the sweep line in, which orders curves meeting at the event point
+    double SlopeAt(uint32_t index, double x) const {
+        constexpr double INF = std::numeric_limits<double>::infinity();
+        const Curve& curve = curves[index];
+        if (curve.half == 0) {
+            if (curve.vertical) return INF;
+            return (curve.right.y - curve.left.y) / (curve.right.x - curve.left.x);
+        }
+        const Primitive& circle = primitives[curve.primitive];
+        double dx = x - circle.a.x;
+        double height = std::sqrt(std::max(0.0, double(circle.radius) * circle.radius - dx * dx));
+        if (height == 0) return dx < 0 ? curve.half * INF : -curve.half * INF;
+        return -curve.half * dx / height;
+    }
+
+    static bool SamePair(const Hold& hold, uint32_t a, uint32_t b) {
+        return (hold.lower == a && hold.upper == b) || (hold.lower == b && hold.upper == a);
+    }
+
+    // The pair's held order, if it has one
+    const Hold* Held(uint32_t a, uint32_t b) const {
+        auto hold = std::find_if(held.begin(), held.end(), [a, b](const Hold& hold) { return SamePair(hold, a, b); });
+        return hold == held.end() ? nullptr : &*hold;
+    }
+
+    void HoldOrder(uint32_t lower, uint32_t upper, bool crossed) {
+        auto hold = std::find_if(
+            held.begin(), held.end(), [lower, upper](const Hold& hold) { return SamePair(hold, lower, upper); });
+        if (hold == held.end()) {
+            held.push_back(Hold{lower, upper, crossed});
+        } else {
+            *hold = Hold{lower, upper, crossed};
+        }
+    }
+
+    bool Below(uint32_t a, uint32_t b) const {
+        if (a == b) return false;
+        if (!held.empty() && a != PROBE && b != PROBE) {
+            if (const Hold* hold = Held(a, b)) return hold->lower == a;
+        }
+        double ya = YAt(a, sweep.x), yb = YAt(b, sweep.x);
+        if (a == PROBE) return yb >= ya - tolerance;
+        if (b == PROBE) return ya < yb - tolerance;
+        if (std::abs(ya - yb) > tolerance) return ya < yb;
+        double sa = SlopeAt(a, sweep.x), sb = SlopeAt(b, sweep.x);
+        if (sa != sb) return sa < sb;
+        return a < b;
+    }
+
+    // True if the curve passes within the tolerance of the event point. Measured as a distance rather than along the
+    // sweep line, so steep curves through the point are not missed.
+    bool PassesEvent(uint32_t index) const {
+        const Curve& curve = curves[index];
+        double px = sweep.x, py = sweep.y;
+        if (curve.half == 0) {
+            double dx = curve.right.x - curve.left.x, dy = curve.right.y - curve.left.y;
+            double t = ((px - curve.left.x) * dx + (py - curve.left.y) * dy) / (dx * dx + dy * dy);
+            t = std::clamp(t, 0.0, 1.0);
+            return std::hypot(curve.left.x + dx * t - px, curve.left.y + dy * t - py) <= tolerance;
+        }
+        const Primitive& circle = primitives[curve.primitive];
+        if ((py - circle.a.y) * curve.half >= 0) {
+            return std::abs(std::hypot(px - circle.a.x, py - circle.a.y) - circle.radius) <= tolerance;
+        }
+        return std::min(std::hypot(px - curve.left.x, py - curve.left.y),
+                   std::hypot(px - curve.right.x, py - curve.right.y)) <= tolerance;
+    }
+
+    void AddCurve(uint32_t primitive, int half, Point a, Point b) {
+        // Ends are ordered by their keys, so the start is always handled before the end
+        Key left = KeyOf(a), right = KeyOf(b);
+        if (left == right) return;
+        bool swap = right < left;
+        if (swap) std::swap(left, right);
+        Curve curve{primitive, half, swap ? b : a, swap ? a : b, false};
+        curve.vertical = left.x == right.x;
+
+        uint32_t index = curves.size();
+        curves.push_back(curve);
+        Event& start = queue.try_emplace(left, Event{curve.left, {}, {}}).first->second;
+        start.starts.push_back(index);
+        Event& end = queue.try_emplace(right, Event{curve.right, {}, {}}).first->second;
+        end.ends.push_back(index);
+    }
+
+    Core::Intersections Intersect(uint32_t a, uint32_t b) const {
+        const Curve& ca = curves[a];
+        const Curve& cb = curves[b];
+        const Primitive& pa = primitives[ca.primitive];
+        const Primitive& pb = primitives[cb.primitive];
+        Core::Intersections found;
+        if (ca.primitive == cb.primitive) return found;
+        if (pa.kind == Primitive::Kind::Segment && pb.kind == Primitive::Kind::Segment) {
+            found = Core::IntersectSegments(pa.a, pa.b, pb.a, pb.b);
+        } else if (pa.kind == Primitive::Kind::Segment) {
+            found = Core::IntersectSegmentCircle(pa.a, pa.b, pb.a, pb.radius);
+        } else if (pb.kind == Primitive::Kind::Segment) {
+            found = Core::IntersectSegmentCircle(pb.a, pb.b, pa.a, pa.radius);
+        } else {
+            found = Core::IntersectCircles(pa.a, pa.radius, pb.a, pb.radius);
+        }
+
+        // Keep the points on the right halves of the circles
+        Core::Intersections result;
+        for (int i = 0; i < found.count; i++) {
+            bool on_a = ca.half == 0 || (found.points[i].y - pa.a.y) * ca.half >= -tolerance;
+            bool on_b = cb.half == 0 || (found.points[i].y - pb.a.y) * cb.half >= -tolerance;
+            if (on_a && on_b) result.Add(found.points[i]);
+        }
+        return result;
+    }
+
+    // Segments of one object sharing a vertex meet there by construction, that is not an intersection
+    bool SharesVertex(const Primitive& a, const Primitive& b, Core::Vector2 point) const {
+        if (a.owner != b.owner) return false;
+        if (a.kind != Primitive::Kind::Segment || b.kind != Primitive::Kind::Segment) return false;
+        for (Core::Vector2 end : {a.a, a.b}) {
+            if (!(end == b.a) && !(end == b.b)) continue;
+            if (std::abs(end.x - point.x) <= tolerance && std::abs(end.y - point.y) <= tolerance) return true;
+        }
+        return false;
+    }
+
+    // Collinear segments and coincident circles have no single meeting point, only the ends of the overlap count
+    bool Overlapping(const Primitive& a, const Primitive& b) const {
+        if (a.kind != b.kind) return false;
+        if (a.kind == Primitive::Kind::Circle) return a.a == b.a && a.radius == b.radius;
+        double ax = double(a.b.x) - a.a.x, ay = double(a.b.y) - a.a.y;
+        double bx = double(b.b.x) - b.a.x, by = double(b.b.y) - b.a.y;
+        return std::abs(ax * by - ay * bx) <= 1e-9 * std::hypot(ax, ay) * std::hypot(bx, by);
+    }
+
+    // The first passing entries of meeting go through the point, the rest start or end there
+    void Report(const std::vector<uint32_t>& meeting, size_t passing, Point point) {
+        Core::Vector2 at(point.x, point.y);
+        for (size_t i = 0; i < meeting.size(); i++) {
+            for (size_t j = i + 1; j < meeting.size(); j++) {
+                uint32_t a = curves[meeting[i]].primitive, b = curves[meeting[j]].primitive;
+                if (a == b || SharesVertex(primitives[a], primitives[b], at)) continue;
+                if (j < passing && Overlapping(primitives[a], primitives[b])) continue;
+                crossings.push_back(IntersectionIndex::Crossing{at, std::min(a, b), std::max(a, b)});
+            }
+        }
+    }
+
+    void ReportInColumn(uint32_t a, uint32_t b, Key current) {
+        Core::Intersections found = Intersect(a, b);
+        for (int i = 0; i < found.count; i++) {
+            Point point{found.points[i].x, found.points[i].y};
+            if (KeyOf(point).x == current.x) Report(std::vector<uint32_t>{a, b}, 0, point);
+        }
+    }
+
+    // Queue the intersections of two new neighbours (a right below b) that the sweep has not passed yet
+    void FindEvents(uint32_t a, uint32_t b, Key current) {
+        // A pair that met in this column has been reported already, and flipping it back could go on forever where
+        // three or more curves meet
+        const Hold* hold = Held(a, b);
+        bool settled = hold != nullptr && hold->crossed;
+        Core::Intersections found = Intersect(a, b);
+        bool late = false;
+        double late_x = -std::numeric_limits<double>::infinity();
+        for (int i = 0; i < found.count; i++) {
+            Point point{found.points[i].x, found.points[i].y};
+            Key key = KeyOf(point);
+            // The event point itself, which rounding can put in a neighbouring cell
+            if (std::abs(point.x - sweep.x) <= tolerance && std::abs(point.y - sweep.y) <= tolerance) continue;
+            if (current < key) {
+                queue.try_emplace(key, Event{point, {}, {}});
+            } else if (!settled && key.x >= current.x - 1 && !curves[a].vertical && !curves[b].vertical) {
+                // Steep curves (or arcs near their vertical tangents) can meet just below the event point, in the
+                // column the sweep is already past or, rounded, the one before it. Too close to have an event of
+                // their own, so report the point now and put the two in the order they have after it. Vertical
+                // segments are ordered by the events along them and don't need this.
+                Report(std::vector<uint32_t>{a, b}, 0, point);
+                late = true;
+                late_x = std::max(late_x, point.x);
+            }
+        }
+        // The same point can be an event in two neighbouring cells, and the pair may already be in order from the
+        // first of them, so the slopes rather than the number of crossings decide
+        if (!late || SlopeAt(a, late_x) <= SlopeAt(b, late_x)) return;
+
+        // The status compares by position on the sweep line, so the pair is taken out and put back under the
+        // new order rather than changed in place. Either curve may be past more curves on the line than just the
+        // other one; held next to the pair, it is swapped past them one at a time and meets each of them.
+        for (auto it = positions[a]; it != status.begin() && Below(b, *std::prev(it)); --it) {
+            HoldOrder(*std::prev(it), b, false);
+        }
+        for (auto it = std::next(positions[b]); it != status.end() && Below(*it, a); ++it) {
+            HoldOrder(a, *it, false);
+        }
+        status.erase(positions[a]);
+        status.erase(positions[b]);
+        HoldOrder(b, a, true);
+        positions[b] = status.insert(b).first;
+        positions[a] = status.insert(a).first;
+        if (positions[b] != status.begin()) FindEvents(*std::prev(positions[b]), b, current);
+        if (std::next(positions[a]) != status.end()) FindEvents(a, *std::next(positions[a]), current);
+    }
+
+    void Handle(Key key, const Event& event) {
+        sweep = Point{key.x * tolerance, key.y * tolerance};
+        if (key.x != column) held.clear();
+        column = key.x;
+
+        // Curves passing through the event point sit around the probe in the status. A point the sweep has already
+        // been through in a neighbouring cell comes back as a second event, which the curves that met there are all
+        // part of, though some may pass just outside the tolerance of this one.
+        std::vector<uint32_t> passing;
+        auto at_point = [this, &passing](uint32_t index) {
+            if (PassesEvent(index)) return true;
+            return std::any_of(passing.begin(), passing.end(), [this, index](uint32_t other) {
+                const Hold* hold = Held(index, other);
+                return hold != nullptr && hold->crossed;
+            });
+        };
+        auto probe = status.lower_bound(PROBE);
+        for (auto it = probe; it != status.begin() && at_point(*std::prev(it)); --it) {
+            passing.push_back(*std::prev(it));
+        }
+        for (auto it = probe; it != status.end() && at_point(*it); ++it) {
+            passing.push_back(*it);
+        }
+        passing.erase(std::remove_if(passing.begin(), passing.end(),
+                          [&event](uint32_t index) {
+                              return std::find(event.ends.begin(), event.ends.end(), index) != event.ends.end();
+                          }),
+            passing.end());
+
+        std::vector<uint32_t> meeting = passing;
+        meeting.insert(meeting.end(), event.starts.begin(), event.starts.end());
+        meeting.insert(meeting.end(), event.ends.begin(), event.ends.end());
+        if (meeting.size() > 1) Report(meeting, passing.size(), event.point);
+
+        // Likewise a steep curve can still meet a neighbour in this column above its end point, after its end in
+        // event order
+        for (uint32_t index : event.ends) {
+            if (curves[index].vertical) continue;
+            auto position = positions[index];
+            if (position != status.begin()) ReportInColumn(*std::prev(position), index, key);
+            if (std::next(position) != status.end()) ReportInColumn(index, *std::next(position), key);
+        }
+        for (uint32_t index : event.ends) {
+            status.erase(positions[index]);
+        }
+        for (uint32_t index : passing) {
+            status.erase(positions[index]);
+        }
+
+        // Reinserted at the event's y the curves through it only compare by slope among themselves, which puts them
+        // in their order right of the event point
+        std::vector<uint32_t> inserted = passing;
+        inserted.insert(inserted.end(), event.starts.begin(), event.starts.end());
+        for (uint32_t index : inserted) {
+            at_event[index] = true;
+        }
+        for (uint32_t index : inserted) {
+            positions[index] = status.insert(index).first;
+        }
+
+        if (inserted.empty()) {
+            auto above = status.lower_bound(PROBE);
+            if (above != status.end() && above != status.begin()) FindEvents(*std::prev(above), *above, key);
+            return;
+        }
+        auto first = positions[inserted[0]], last = first;
+        while (first != status.begin() && at_event[*std::prev(first)]) {
+            --first;
+        }
+        while (std::next(last) != status.end() && at_event[*std::next(last)]) {
+            ++last;
+        }
+        // Searches can take nodes out of the status, so the group is kept by value and looked up again
+        std::vector<uint32_t> group(first, std::next(last));
+        for (uint32_t index : inserted) {
+            at_event[index] = false;
+        }
+        // Off the event point steep curves through it can be apart by more than the tolerance, in the order they had
+        // left of it, which has to be overruled for the rest of the column
+        for (size_t i = 0; i < group.size(); i++) {
+            for (size_t j = i + 1; j < group.size(); j++) {
+                if (Below(group[j], group[i])) HoldOrder(group[i], group[j], true);
+            }
+        }
+        // A segment and a circle (or two circles) leaving the point next to each other can meet once more
+        for (size_t i = 1; i < group.size(); i++) {
+            if (std::next(positions[group[i - 1]]) == positions[group[i]]) FindEvents(group[i - 1], group[i], key);
+        }
+        first = positions[group.front()];
+        if (first != status.begin()) FindEvents(*std::prev(first), *first, key);
+        last = positions[group.back()];
+        if (std::next(last) != status.end()) FindEvents(*last, *std::next(last), key);
+    }
+
+  public:
+    Sweeper(const std::vector<Primitive>& primitives) : primitives(primitives), status(StatusLess{this}) {
+        // Tolerance relative to the size of the coordinates, a little above what float inputs can resolve
+        double extent = 1;
+        for (const Primitive& primitive : primitives) {
+            for (Core::Vector2 point : {primitive.a, primitive.b}) {
+                extent = std::max({extent, double(std::abs(point.x)), double(std::abs(point.y))});
+            }
+            extent = std::max(extent, double(primitive.radius));
+        }
+        tolerance = extent * 1e-6;
+
+        for (uint32_t i = 0; i < primitives.size(); i++) {
+            const Primitive& primitive = primitives[i];
+            if (primitive.kind == Primitive::Kind::Segment) {
+                AddCurve(i, 0, Point{primitive.a.x, primitive.a.y}, Point{primitive.b.x, primitive.b.y});
+                continue;
+            }
+            Point left{double(primitive.a.x) - primitive.radius, double(primitive.a.y)};
+            Point right{double(primitive.a.x) + primitive.radius, double(primitive.a.y)};
+            AddCurve(i, 1, left, right);
+            AddCurve(i, -1, left, right);
+        }
+        positions.resize(curves.size());
+        at_event.resize(curves.size());
+    }
+
+    std::vector<IntersectionIndex::Crossing> Run() {
+        while (!queue.empty()) {
+            auto next = queue.begin();
+            Handle(next->first, next->second);
+            queue.erase(next);
+        }
+
+        // A pair can be reported twice for one point, from events in neighbouring cells (an end lying on the other
+        // curve, and the crossing computed from the two). Sorted by pair and position such reports end up adjacent.
+        auto order = [](const IntersectionIndex::Crossing& a, const IntersectionIndex::Crossing& b) {
+            return std::tie(a.first, a.second, a.point.x, a.point.y) <
+                   std::tie(b.first, b.second, b.point.x, b.point.y);
+        };
+        auto same = [this](const IntersectionIndex::Crossing& a, const IntersectionIndex::Crossing& b) {
+            return a.first == b.first && a.second == b.second && std::abs(a.point.x - b.point.x) <= 2 * tolerance &&
+                   std::abs(a.point.y - b.point.y) <= 2 * tolerance;
+        };
+        std::sort(crossings.begin(), crossings.end(), order);
+        crossings.erase(std::unique(crossings.begin(), crossings.end(), same), crossings.end());
+        return std::move(crossings);
+    }
+};
+
+} // namespace
+
+std::vector<IntersectionIndex::Crossing> IntersectionIndex::Sweep(const std::vector<Primitive>& primitives)
+{
+    return Sweeper(primitives).Run();
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    Maintenance                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+void IntersectionIndex::Add(const Intersection& intersection)
+{
+    uint32_t slot;
+    if (free_slots.empty()) {
+        slot = intersections.size();
+        intersections.push_back(intersection);
+    } else {
+        slot = free_slots.back();
+        free_slots.pop_back();
+        intersections[slot] = intersection;
+    }
+    points.Insert(slot, Core::Bounds(intersection.point, intersection.point));
+
+    for (ObjectId id : {intersection.a, intersection.b}) {
+        std::vector<uint32_t>* slots = by_object.Find(id);
+        if (slots == nullptr) {
+            by_object.Insert(id, {slot});
+        } else if (id != intersection.a || intersection.a != intersection.b) {
+            slots->push_back(slot);
+        }
+    }
+}
+
+void IntersectionIndex::Remove(ObjectId id)
+{
+    std::vector<uint32_t>* slots = by_object.Find(id);
+    if (slots == nullptr) return;
+    std::vector<uint32_t> removed = std::move(*slots);
+    by_object.Remove(id);
+
+    for (uint32_t slot : removed) {
+        const Intersection& intersection = intersections[slot];
+        ObjectId other = intersection.a == id ? intersection.b : intersection.a;
+        if (std::vector<uint32_t>* others = by_object.Find(other)) {
+            others->erase(std::remove(others->begin(), others->end(), slot), others->end());
+            if (others->empty()) by_object.Remove(other);
+        }
+        points.Remove(slot, Core::Bounds(intersection.point, intersection.point));
+        free_slots.push_back(slot);
+    }
+}
+
+void IntersectionIndex::Rebuild(const ObjectRegistry& registry)
+{
+    intersections.clear();
+    free_slots.clear();
+    points.Clear();
+    by_object.Clear();
+
+    std::vector<Primitive> primitives;
+    registry.Visit([&primitives](auto& object) { Decompose(object, primitives); });
+    for (const Crossing& crossing : Sweep(primitives)) {
+        Add(Intersection{crossing.point, primitives[crossing.first].owner, primitives[crossing.second].owner});
+    }
+}
+
+void IntersectionIndex::Update(const ObjectRegistry& registry, const std::vector<ObjectId>& changed)
+{
+    std::unordered_set<ObjectId> changed_set(changed.begin(), changed.end());
+    for (ObjectId id : changed) {
+        Remove(id);
+    }
+
+    // Sweep the changed objects together with everything their bounds touch, and keep only the crossings that
+    // involve a changed object; the rest are already in the index
+    std::vector<Core::Bounds> regions;
+    for (auto& reference : registry.Find(changed)) {
+        if (reference->NotValid()) continue;
+        registry.Visit(std::vector<ObjectRegistry::Reference>{reference},
+            [&regions](auto& object) { regions.push_back(object.GetBounds()); });
+    }
+    std::unordered_set<ObjectId> swept;
+    std::vector<Primitive> primitives;
+    for (const Core::Bounds& region : regions) {
+        registry.Visit(region, LayerFilter::All, [&swept, &primitives](auto& object) {
+            if (swept.insert(object.GetId()).second) Decompose(object, primitives);
+        });
+    }
+
+    for (const Crossing& crossing : Sweep(primitives)) {
+        ObjectId a = primitives[crossing.first].owner, b = primitives[crossing.second].owner;
+        if (changed_set.count(a) == 0 && changed_set.count(b) == 0) continue;
+        Add(Intersection{crossing.point, a, b});
+    }
+}
+
+void IntersectionIndex::Sync(const ObjectRegistry& registry)
+{
+    auto& journal = registry.GetJournal();
+    if (!synced) {
+        cursor = journal.GetCursor();
+        Rebuild(registry);
+        synced = true;
+        return;
+    }
+
+    std::vector<ObjectId> changed;
+    bool complete = journal.Read(
+        cursor, [&changed](const ObjectRegistry::Journal::Record& record) { changed.push_back(record.handle); });
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+    // Past an eighth of the drawing one sweep over everything is cheaper than many overlapping partial ones
+    if (!complete || changed.size() * 8 > registry.Count()) {
+        Rebuild(registry);
+    } else if (!changed.empty()) {
+        Update(registry, changed);
+    }
+}
+
+} // namespace Cad
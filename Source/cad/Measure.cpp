@@ -0,0 +1,61 @@
+#include <cad/object/Measure.h>
+#include <cad/object/ObjectVisitor.h>
+
+namespace Cad {
+
+void Measurement::Merge(const Measurement& other)
+{
+    count += other.count;
+    for (size_t type = 0; type < by_type.size(); type++) {
+        by_type[type] += other.by_type[type];
+    }
+    length += other.length;
+    area += other.area;
+    extents.Expand(other.extents);
+}
+
+namespace {
+struct MeasureVisitor : public ConstObjectVisitor {
+    const CompiledQuery& query;
+    Measurement measurement;
+
+    MeasureVisitor(const CompiledQuery& query) : query(query) {}
+
+    template <typename T> void Add(const T& object) {
+        if (query.Matches(object)) measurement.Add(object);
+    }
+
+    void Visit(const LineObject& object) override { Add(object); }
+    void Visit(const CircleObject& object) override { Add(object); }
+    void Visit(const PolylineObject& object) override { Add(object); }
+    void Visit(const InsertObject& object) override { Add(object); }
+    void Visit(const HatchObject& object) override { Add(object); }
+};
+} // namespace
+
+Measurement Measure(const ObjectRegistry& registry, const Query& query)
+{
+    Measurement result;
+    CompiledQuery compiled = registry.Compile(query);
+    if (!compiled.MayMatch()) return result;
+    for (auto& visitor : registry.ParallelVisitObjects<MeasureVisitor>(compiled)) {
+        result.Merge(visitor.measurement);
+    }
+    return result;
+}
+
+const Measurement& MeasurementCache::Get(const ObjectRegistry& registry, Scope scope)
+{
+    auto& slot = cached[size_t(scope)];
+    // The drawing's measurements don't depend on the selection
+    uint64_t selection_revision = scope == Scope::Selection ? registry.GetSelectionRevision() : 0;
+    if (slot && slot->revision == registry.GetRevision() && slot->selection_revision == selection_revision) {
+        return slot->measurement;
+    }
+
+    Query query = scope == Scope::Selection ? Query::Selected() : Query::All();
+    slot = Cached{registry.GetRevision(), selection_revision, Measure(registry, query)};
+    return slot->measurement;
+}
+
+} // namespace Cad
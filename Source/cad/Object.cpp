@@ -1,6 +1,9 @@
+#include <cad/object/Block.h>
 #include <cad/object/Object.h>
+#include <cad/object/ObjectVariant.h>
 #include <cad/object/ObjectVisitor.h>
 
+#include <cmath>
 #include <sstream>
 #include <iomanip>
 
@@ -11,13 +14,31 @@ namespace Cad
 /*                                                        Line                                                        */
 /* ------------------------------------------------------------------------------------------------------------------ */
 
-LineObject::LineObject(Core::Vector2 start, Core::Vector2 end) : start(start), end(end) {}
+LineObject::LineObject(Core::Vector2 start, Core::Vector2 end) : Object(ObjectType::Line), start(start), end(end) {}
+
+void* LineObject::operator new(std::size_t size)
+{
+    // Subclasses have a different footprint and must not land in this pool
+    if (size != sizeof(LineObject)) return ::operator new(size);
+    return PoolFor<LineObject>().Allocate();
+}
+
+void LineObject::operator delete(void* ptr, std::size_t size)
+{
+    if (size != sizeof(LineObject)) {
+        ::operator delete(ptr);
+        return;
+    }
+    PoolFor<LineObject>().Deallocate(ptr);
+}
 
 void LineObject::Accept(ObjectVisitor& visitor) { visitor.Visit(*this); }
 
+void LineObject::Accept(ConstObjectVisitor& visitor) const { visitor.Visit(*this); }
+
 std::unique_ptr<Object> LineObject::Clone() const
 {
-    auto clone = std::make_unique<LineObject>(start, end);
+    auto clone = std::make_unique<LineObject>(*this);
     return clone;
 }
 
@@ -29,17 +50,38 @@ std::string LineObject::ToString() const
     return ss.str();
 }
 
+Core::Bounds LineObject::GetBounds() const { return Core::Bounds::FromPoints(start, end); }
+
 /* ------------------------------------------------------------------------------------------------------------------ */
 /*                                                       Circle                                                       */
 /* ------------------------------------------------------------------------------------------------------------------ */
 
-CircleObject::CircleObject(Core::Vector2 center, float radius) : center(center), radius(radius) {}
+CircleObject::CircleObject(Core::Vector2 center, float radius)
+    : Object(ObjectType::Circle), center(center), radius(radius) {}
+
+void* CircleObject::operator new(std::size_t size)
+{
+    // Subclasses have a different footprint and must not land in this pool
+    if (size != sizeof(CircleObject)) return ::operator new(size);
+    return PoolFor<CircleObject>().Allocate();
+}
+
+void CircleObject::operator delete(void* ptr, std::size_t size)
+{
+    if (size != sizeof(CircleObject)) {
+        ::operator delete(ptr);
+        return;
+    }
+    PoolFor<CircleObject>().Deallocate(ptr);
+}
 
 void CircleObject::Accept(ObjectVisitor& visitor) { visitor.Visit(*this); }
 
+void CircleObject::Accept(ConstObjectVisitor& visitor) const { visitor.Visit(*this); }
+
 std::unique_ptr<Object> CircleObject::Clone() const 
 {
-    auto clone = std::make_unique<CircleObject>(center, radius);
+    auto clone = std::make_unique<CircleObject>(*this);
     return clone;
 }
 
@@ -51,17 +93,40 @@ std::string CircleObject::ToString() const
     return ss.str();
 }
 
+Core::Bounds CircleObject::GetBounds() const
+{
+    return Core::Bounds(center - radius, center + radius);
+}
+
 /* ------------------------------------------------------------------------------------------------------------------ */
 /*                                                      Polyline                                                      */
 /* ------------------------------------------------------------------------------------------------------------------ */
 
-PolylineObject::PolylineObject(std::vector<Core::Vector2> points) : points(points) {}
+PolylineObject::PolylineObject(VertexList points) : Object(ObjectType::Polyline), points(std::move(points)) {}
+
+void* PolylineObject::operator new(std::size_t size)
+{
+    // Subclasses have a different footprint and must not land in this pool
+    if (size != sizeof(PolylineObject)) return ::operator new(size);
+    return PoolFor<PolylineObject>().Allocate();
+}
+
+void PolylineObject::operator delete(void* ptr, std::size_t size)
+{
+    if (size != sizeof(PolylineObject)) {
+        ::operator delete(ptr);
+        return;
+    }
+    PoolFor<PolylineObject>().Deallocate(ptr);
+}
 
 void PolylineObject::Accept(ObjectVisitor& visitor) { visitor.Visit(*this); }
 
+void PolylineObject::Accept(ConstObjectVisitor& visitor) const { visitor.Visit(*this); }
+
 std::unique_ptr<Object> PolylineObject::Clone() const 
 {
-    auto clone = std::make_unique<PolylineObject>(points);
+    auto clone = std::make_unique<PolylineObject>(*this);
     return clone;
 }
 
@@ -76,37 +141,300 @@ std::string PolylineObject::ToString() const
     return ss.str();
 }
 
-} // namespace Cad::Core
+Core::Bounds PolylineObject::GetBounds() const
+{
+    Core::Bounds bounds;
+    for (auto& point : points) {
+        bounds.Expand(point);
+    }
+    return bounds;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Insert                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+InsertObject::InsertObject(std::shared_ptr<const BlockDefinition> block, Core::Transform transform)
+    : Object(ObjectType::Insert), block(std::move(block)), transform(transform) {}
+
+void* InsertObject::operator new(std::size_t size)
+{
+    // Subclasses have a different footprint and must not land in this pool
+    if (size != sizeof(InsertObject)) return ::operator new(size);
+    return PoolFor<InsertObject>().Allocate();
+}
 
-// void Line::Update(Controller& controller)
-// {
-//     bool is_selected = controller.GetClipboard().IsSelected(id);
-//     Pixel color = is_selected ? Color::RED : Color::WHITE;
-//     controller.GetGraphics().DrawLine(color, start.x, start.y, end.x, end.y);
-// }
-
-// bool Line::IsHovered(Controller& controller)
-// {
-//     // mouse pick the line segment with some tolerance
-//     Vector2 screen_mouse = controller.GetCursor().GetPosition();
-//     Vector2 world_mouse = controller.GetCamera().ScreenToWorld(screen_mouse);
-//     Vector2 closest_point = world_mouse.ClosestPointOnLine(start, end);
-//     float distance = (world_mouse - closest_point).Length();
-//     return distance < 2;
-// }
-
-// void Circle::Update(Controller& controller)
-// {
-//     bool is_selected = controller.GetClipboard().IsSelected(id);
-//     Pixel color = is_selected ? Color::RED : Color::WHITE;
-//     controller.GetGraphics().DrawCircle(color, center.x, center.y, radius);
-// }
-
-// bool Circle::IsHovered(Controller& controller)
-// {
-//     // Determine if the mouse is within the circle
-//     Vector2 screen_mouse = controller.GetCursor().GetPosition();
-//     Vector2 world_mouse = controller.GetCamera().ScreenToWorld(screen_mouse);
-//     bool is_hovered = (world_mouse - center).Length() < radius;
-//     return (world_mouse - center).Length() < radius;
-// }
\ No newline at end of file
+void InsertObject::operator delete(void* ptr, std::size_t size)
+{
+    if (size != sizeof(InsertObject)) {
+        ::operator delete(ptr);
+        return;
+    }
+    PoolFor<InsertObject>().Deallocate(ptr);
+}
+
+void InsertObject::Accept(ObjectVisitor& visitor) { visitor.Visit(*this); }
+
+void InsertObject::Accept(ConstObjectVisitor& visitor) const { visitor.Visit(*this); }
+
+std::unique_ptr<Object> InsertObject::Clone() const
+{
+    auto clone = std::make_unique<InsertObject>(*this);
+    return clone;
+}
+
+std::string InsertObject::ToString() const
+{
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "Insert: " << block->name << " at " << transform.x << ", " << transform.y << " x" << transform.scale;
+    return ss.str();
+}
+
+// Bounds of the block's bounding box once transformed, all four corners are needed when the insert is rotated
+Core::Bounds InsertObject::GetBounds() const
+{
+    const Core::Bounds& local = block->bounds;
+    if (local.IsEmpty()) return local;
+
+    Core::Bounds bounds;
+    bounds.Expand(transform.Apply(local.min));
+    bounds.Expand(transform.Apply(local.max));
+    bounds.Expand(transform.Apply(Core::Vector2(local.min.x, local.max.y)));
+    bounds.Expand(transform.Apply(Core::Vector2(local.max.x, local.min.y)));
+    return bounds;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Hatch                                                        */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+HatchObject::HatchObject(std::vector<std::vector<Core::Vector2>> loops, std::vector<ObjectId> boundaries, float angle,
+    float spacing, Core::FillRule rule)
+    : Object(ObjectType::Hatch), loops(std::move(loops)), boundaries(std::move(boundaries)), rule(rule), angle(angle),
+      spacing(spacing) {}
+
+void* HatchObject::operator new(std::size_t size)
+{
+    // Subclasses have a different footprint and must not land in this pool
+    if (size != sizeof(HatchObject)) return ::operator new(size);
+    return PoolFor<HatchObject>().Allocate();
+}
+
+void HatchObject::operator delete(void* ptr, std::size_t size)
+{
+    if (size != sizeof(HatchObject)) {
+        ::operator delete(ptr);
+        return;
+    }
+    PoolFor<HatchObject>().Deallocate(ptr);
+}
+
+void HatchObject::Accept(ObjectVisitor& visitor) { visitor.Visit(*this); }
+
+void HatchObject::Accept(ConstObjectVisitor& visitor) const { visitor.Visit(*this); }
+
+std::unique_ptr<Object> HatchObject::Clone() const
+{
+    auto clone = std::make_unique<HatchObject>(*this);
+    return clone;
+}
+
+std::string HatchObject::ToString() const
+{
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "Hatch: " << loops.size() << " loops, ";
+    if (IsSolid()) {
+        ss << "solid";
+    } else {
+        ss << spacing << " apart at " << angle * 180 / M_PI;
+    }
+    return ss.str();
+}
+
+Core::Bounds HatchObject::GetBounds() const
+{
+    Core::Bounds bounds;
+    for (auto& loop : loops) {
+        for (auto& point : loop) {
+            bounds.Expand(point);
+        }
+    }
+    return bounds;
+}
+
+// Turned so that the pattern lines run along x, the lines are the scanlines of the loops and each span is a piece of
+// line inside the hatch
+void HatchObject::PatternLines(
+    const Core::Bounds& region, const std::function<void(Core::Vector2, Core::Vector2)>& function) const
+{
+    if (IsSolid()) return;
+    Core::Bounds window = region.Intersected(GetBounds());
+    if (window.IsEmpty()) return;
+
+    float cos = std::cos(angle), sin = std::sin(angle);
+    auto to_pattern = [cos, sin](Core::Vector2 p) {
+        return Core::Vector2(p.x * cos + p.y * sin, p.y * cos - p.x * sin);
+    };
+    auto to_world = [cos, sin](Core::Vector2 p) {
+        return Core::Vector2(p.x * cos - p.y * sin, p.x * sin + p.y * cos);
+    };
+
+    float low = INFINITY, high = -INFINITY;
+    for (Core::Vector2 corner : {window.min, window.max, Core::Vector2(window.min.x, window.max.y),
+             Core::Vector2(window.max.x, window.min.y)}) {
+        float y = to_pattern(corner).y;
+        low = std::min(low, y);
+        high = std::max(high, y);
+    }
+    float first = std::ceil(low / spacing) * spacing;
+    int count = int(std::floor((high - first) / spacing)) + 1;
+    if (count <= 0) return;
+
+    std::vector<std::vector<Core::Vector2>> turned(loops.size());
+    for (size_t i = 0; i < loops.size(); i++) {
+        turned[i].reserve(loops[i].size());
+        for (auto& point : loops[i]) {
+            turned[i].push_back(to_pattern(point));
+        }
+    }
+    Core::ScanPolygon(turned, rule, first, spacing, count, [&](float y, float x0, float x1) {
+        Core::Vector2 a = to_world(Core::Vector2(x0, y));
+        Core::Vector2 direction = to_world(Core::Vector2(x1, y)) - a;
+        double t0 = 0, t1 = 1;
+        if (!Core::ClipLine(a, direction, window, t0, t1)) return;
+        function(a + direction * float(t0), a + direction * float(t1));
+    });
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Transforms                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+PointScatter::PointScatter(const Core::PointBatch& points, const Core::Matrix3& matrix)
+    : points(points), matrix(matrix), scale(std::sqrt(std::abs(matrix.Determinant()))),
+      rotation(std::atan2(matrix.data[3], matrix.data[0]))
+{
+}
+
+float PointScatter::Direction(float angle) const
+{
+    float x = std::cos(angle), y = std::sin(angle);
+    return std::atan2(matrix.data[3] * x + matrix.data[4] * y, matrix.data[0] * x + matrix.data[1] * y);
+}
+
+Core::Vector2 PointScatter::Next()
+{
+    Core::Vector2 point(points.x[next], points.y[next]);
+    next++;
+    return point;
+}
+
+namespace {
+void Gather(const LineObject& line, Core::PointBatch& points)
+{
+    points.Add(line.start);
+    points.Add(line.end);
+}
+
+void Gather(const CircleObject& circle, Core::PointBatch& points) { points.Add(circle.center); }
+
+void Gather(const PolylineObject& polyline, Core::PointBatch& points)
+{
+    for (auto& point : polyline.points) {
+        points.Add(point);
+    }
+}
+
+void Gather(const InsertObject& insert, Core::PointBatch& points)
+{
+    points.Add(Core::Vector2(insert.transform.x, insert.transform.y));
+}
+
+void Gather(const HatchObject& hatch, Core::PointBatch& points)
+{
+    for (auto& loop : hatch.loops) {
+        for (auto& point : loop) {
+            points.Add(point);
+        }
+    }
+}
+
+void Scatter(LineObject& line, PointScatter& scatter)
+{
+    line.start = scatter.Next();
+    line.end = scatter.Next();
+}
+
+void Scatter(CircleObject& circle, PointScatter& scatter)
+{
+    circle.center = scatter.Next();
+    circle.radius *= scatter.scale;
+}
+
+void Scatter(PolylineObject& polyline, PointScatter& scatter)
+{
+    for (auto& point : polyline.points) {
+        point = scatter.Next();
+    }
+}
+
+void Scatter(InsertObject& insert, PointScatter& scatter)
+{
+    Core::Vector2 origin = scatter.Next();
+    insert.transform = Core::Transform(origin.x, origin.y, insert.transform.scale * scatter.scale,
+        insert.transform.rotation + scatter.rotation);
+}
+
+void Scatter(HatchObject& hatch, PointScatter& scatter)
+{
+    for (auto& loop : hatch.loops) {
+        for (auto& point : loop) {
+            point = scatter.Next();
+        }
+    }
+    hatch.spacing *= scatter.scale;
+    hatch.angle = scatter.Direction(hatch.angle);
+}
+} // namespace
+
+void GatherPoints(const Object& object, Core::PointBatch& points)
+{
+    Dispatch(object, [&points](auto& concrete) { Gather(concrete, points); });
+}
+
+void ScatterPoints(Object& object, PointScatter& scatter)
+{
+    Dispatch(object, [&scatter](auto& concrete) { Scatter(concrete, scatter); });
+}
+
+void TransformObject(Object& object, const Core::Matrix3& matrix)
+{
+    Core::PointBatch points;
+    GatherPoints(object, points);
+    Core::TransformPoints(matrix, points);
+    PointScatter scatter(points, matrix);
+    ScatterPoints(object, scatter);
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                      Variant                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+ObjectVariant ToVariant(const Object& object)
+{
+    return Dispatch(object, [](const auto& concrete) -> ObjectVariant { return concrete; });
+}
+
+std::unique_ptr<Object> FromVariant(const ObjectVariant& variant)
+{
+    return std::visit(
+        [](const auto& concrete) -> std::unique_ptr<Object> {
+            using Concrete = std::decay_t<decltype(concrete)>;
+            return std::make_unique<Concrete>(concrete);
+        },
+        variant);
+}
+
+} // namespace Cad::Core
@@ -0,0 +1,238 @@
+#include <cad/object/Block.h>
+#include <cad/object/ObjectMetrics.h>
+#include <core/math/Geometry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Cad {
+
+float ObjectLength(const LineObject& line) { return (line.end - line.start).Length(); }
+
+float ObjectLength(const CircleObject& circle) { return 2 * M_PI * circle.radius; }
+
+float ObjectLength(const PolylineObject& polyline)
+{
+    float length = 0;
+    for (size_t i = 1; i < polyline.points.size(); i++) {
+        length += (polyline.points[i] - polyline.points[i - 1]).Length();
+    }
+    return length;
+}
+
+float ObjectLength(const InsertObject& insert)
+{
+    float length = 0;
+    insert.block->Visit([&length](auto& object) { length += ObjectLength(object); });
+    return length * insert.transform.scale;
+}
+
+float ObjectLength(const HatchObject&) { return 0; }
+
+float ObjectLength(const Object& object)
+{
+    return Dispatch(object, [](auto& concrete) { return ObjectLength(concrete); });
+}
+
+float ObjectArea(const LineObject&) { return 0; }
+
+float ObjectArea(const CircleObject& circle) { return M_PI * circle.radius * circle.radius; }
+
+float ObjectArea(const PolylineObject& polyline)
+{
+    auto& points = polyline.points;
+    if (points.size() < 4 || !(points.front() == points.back())) return 0;
+    double twice = 0;
+    for (size_t i = 1; i < points.size(); i++) {
+        twice += double(points[i - 1].x) * points[i].y - double(points[i].x) * points[i - 1].y;
+    }
+    return std::abs(twice) / 2;
+}
+
+float ObjectArea(const InsertObject& insert)
+{
+    float area = 0;
+    insert.block->Visit([&area](auto& object) { area += ObjectArea(object); });
+    return area * insert.transform.scale * insert.transform.scale;
+}
+
+namespace {
+double TwiceSignedArea(const std::vector<Core::Vector2>& loop)
+{
+    double twice = 0;
+    for (size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+        twice += double(loop[j].x) * loop[i].y - double(loop[i].x) * loop[j].y;
+    }
+    return twice;
+}
+
+// Even-odd test of one point, for the few loops of a hatch
+bool InsideLoop(Core::Vector2 point, const std::vector<Core::Vector2>& loop)
+{
+    bool inside = false;
+    for (size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+        const Core::Vector2& a = loop[j];
+        const Core::Vector2& b = loop[i];
+        if ((a.y > point.y) == (b.y > point.y)) continue;
+        if (point.x < a.x + (point.y - a.y) * (b.x - a.x) / (b.y - a.y)) inside = !inside;
+    }
+    return inside;
+}
+} // namespace
+
+float ObjectArea(const HatchObject& hatch)
+{
+    double area = 0;
+    for (size_t i = 0; i < hatch.loops.size(); i++) {
+        auto& loop = hatch.loops[i];
+        if (loop.size() < 3) continue;
+        int depth = 0;
+        for (size_t j = 0; j < hatch.loops.size(); j++) {
+            if (j != i && hatch.loops[j].size() > 2 && InsideLoop(loop[0], hatch.loops[j])) depth++;
+        }
+        double twice = std::abs(TwiceSignedArea(loop));
+        area += depth % 2 == 0 ? twice : -twice;
+    }
+    return std::abs(area) / 2;
+}
+
+float ObjectArea(const Object& object)
+{
+    return Dispatch(object, [](auto& concrete) { return ObjectArea(concrete); });
+}
+
+float ObjectDistance(const LineObject& line, Core::Vector2 point)
+{
+    return Core::DistanceToSegment(point, line.start, line.end);
+}
+
+float ObjectDistance(const CircleObject& circle, Core::Vector2 point)
+{
+    return std::abs((point - circle.center).Length() - circle.radius);
+}
+
+float ObjectDistance(const PolylineObject& polyline, Core::Vector2 point)
+{
+    auto& points = polyline.points;
+    if (points.empty()) return std::numeric_limits<float>::infinity();
+    float distance = (point - points[0]).Length();
+    for (size_t i = 1; i < points.size(); i++) {
+        distance = std::min(distance, Core::DistanceToSegment(point, points[i - 1], points[i]));
+    }
+    return distance;
+}
+
+float ObjectDistance(const InsertObject& insert, Core::Vector2 point)
+{
+    // Measured in block space and scaled back out
+    Core::Vector2 local = insert.transform.Inverse().Apply(point);
+    float distance = std::numeric_limits<float>::infinity();
+    insert.block->Visit([&](auto& object) { distance = std::min(distance, ObjectDistance(object, local)); });
+    return distance * insert.transform.scale;
+}
+
+float ObjectDistance(const HatchObject& hatch, Core::Vector2 point)
+{
+    float distance = std::numeric_limits<float>::infinity();
+    for (auto& loop : hatch.loops) {
+        for (size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+            distance = std::min(distance, Core::DistanceToSegment(point, loop[j], loop[i]));
+        }
+    }
+    return distance;
+}
+
+float ObjectDistance(const Object& object, Core::Vector2 point)
+{
+    return Dispatch(object, [point](auto& concrete) { return ObjectDistance(concrete, point); });
+}
+
+namespace {
+bool SegmentCrosses(Core::Vector2 a, Core::Vector2 b, const Core::Bounds& rect)
+{
+    double t0 = 0, t1 = 1;
+    return Core::ClipLine(a, b - a, rect, t0, t1);
+}
+
+// The circle touches the rect when the rect's nearest point is inside it and its farthest corner is not
+bool CircleCrosses(Core::Vector2 center, float radius, const Core::Bounds& rect)
+{
+    if (rect.IsEmpty()) return false;
+    Core::Vector2 nearest(std::clamp(center.x, rect.min.x, rect.max.x), std::clamp(center.y, rect.min.y, rect.max.y));
+    Core::Vector2 farthest(std::max(center.x - rect.min.x, rect.max.x - center.x),
+        std::max(center.y - rect.min.y, rect.max.y - center.y));
+    return (nearest - center).Length() <= radius && farthest.Length() >= radius;
+}
+
+// Block contents are tested in world space, a rotated block turns the rect into something that is not a rect
+bool Crosses(const LineObject& line, const Core::Transform& transform, const Core::Bounds& rect)
+{
+    return SegmentCrosses(transform.Apply(line.start), transform.Apply(line.end), rect);
+}
+
+bool Crosses(const CircleObject& circle, const Core::Transform& transform, const Core::Bounds& rect)
+{
+    return CircleCrosses(transform.Apply(circle.center), circle.radius * std::abs(transform.scale), rect);
+}
+
+bool Crosses(const PolylineObject& polyline, const Core::Transform& transform, const Core::Bounds& rect)
+{
+    auto& points = polyline.points;
+    if (points.size() == 1) return rect.Contains(transform.Apply(points[0]));
+    for (size_t i = 1; i < points.size(); i++) {
+        if (SegmentCrosses(transform.Apply(points[i - 1]), transform.Apply(points[i]), rect)) return true;
+    }
+    return false;
+}
+
+bool Crosses(const HatchObject& hatch, const Core::Transform& transform, const Core::Bounds& rect)
+{
+    for (auto& loop : hatch.loops) {
+        for (size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+            if (SegmentCrosses(transform.Apply(loop[j]), transform.Apply(loop[i]), rect)) return true;
+        }
+    }
+    return false;
+}
+
+bool Crosses(const InsertObject& insert, const Core::Transform& transform, const Core::Bounds& rect)
+{
+    Core::Transform placement = transform * insert.transform;
+    bool crosses = false;
+    insert.block->Visit([&](auto& object) { crosses = crosses || Crosses(object, placement, rect); });
+    return crosses;
+}
+} // namespace
+
+bool ObjectCrosses(const LineObject& line, const Core::Bounds& rect)
+{
+    return SegmentCrosses(line.start, line.end, rect);
+}
+
+bool ObjectCrosses(const CircleObject& circle, const Core::Bounds& rect)
+{
+    return CircleCrosses(circle.center, circle.radius, rect);
+}
+
+bool ObjectCrosses(const PolylineObject& polyline, const Core::Bounds& rect)
+{
+    return Crosses(polyline, Core::Transform::Identity(), rect);
+}
+
+bool ObjectCrosses(const InsertObject& insert, const Core::Bounds& rect)
+{
+    return Crosses(insert, Core::Transform::Identity(), rect);
+}
+
+bool ObjectCrosses(const HatchObject& hatch, const Core::Bounds& rect)
+{
+    return Crosses(hatch, Core::Transform::Identity(), rect);
+}
+
+bool ObjectCrosses(const Object& object, const Core::Bounds& rect)
+{
+    return Dispatch(object, [&rect](auto& concrete) { return ObjectCrosses(concrete, rect); });
+}
+
+} // namespace Cad
@@ -0,0 +1,111 @@
+#include <cad/object/ObjectPool.h>
+
+namespace Cad {
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     BlockPool                                                      */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+BlockPool::BlockPool(std::size_t block_size, std::size_t blocks_per_chunk) : blocks_per_chunk(blocks_per_chunk)
+{
+    // Every block must be able to hold the free list link and keep the alignment of anything placed in it
+    constexpr std::size_t align = alignof(std::max_align_t);
+    if (block_size < sizeof(FreeBlock)) block_size = sizeof(FreeBlock);
+    this->block_size = (block_size + align - 1) / align * align;
+    if (this->blocks_per_chunk == 0) this->blocks_per_chunk = 1;
+}
+
+BlockPool::~BlockPool()
+{
+    for (void* chunk : chunks) {
+        ::operator delete(chunk);
+    }
+}
+
+void BlockPool::Grow()
+{
+    char* chunk = static_cast<char*>(::operator new(block_size * blocks_per_chunk));
+    chunks.push_back(chunk);
+
+    // Thread the new blocks onto the free list back to front so they are handed out in address order
+    for (std::size_t i = blocks_per_chunk; i > 0; i--) {
+        auto block = reinterpret_cast<FreeBlock*>(chunk + (i - 1) * block_size);
+        block->next = free_list;
+        free_list = block;
+    }
+}
+
+void* BlockPool::Allocate()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free_list == nullptr) Grow();
+    FreeBlock* block = free_list;
+    free_list = block->next;
+    return block;
+}
+
+void BlockPool::Deallocate(void* ptr)
+{
+    if (ptr == nullptr) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto block = static_cast<FreeBlock*>(ptr);
+    block->next = free_list;
+    free_list = block;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    VertexArena                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+VertexArena::VertexArena()
+{
+    for (std::size_t i = 0; i < CLASS_COUNT; i++) {
+        std::size_t bytes = MIN_CLASS_BYTES << i;
+        std::size_t per_chunk = CHUNK_BYTES / bytes;
+        classes.push_back(new BlockPool(bytes, per_chunk));
+    }
+}
+
+VertexArena::~VertexArena()
+{
+    for (BlockPool* pool : classes) {
+        delete pool;
+    }
+}
+
+std::size_t VertexArena::ClassOf(std::size_t bytes)
+{
+    std::size_t index = 0;
+    std::size_t size = MIN_CLASS_BYTES;
+    while (size < bytes) {
+        size <<= 1;
+        index++;
+    }
+    return index;
+}
+
+void* VertexArena::Allocate(std::size_t bytes)
+{
+    std::size_t index = ClassOf(bytes);
+    if (index >= CLASS_COUNT) return ::operator new(bytes);
+    return classes[index]->Allocate();
+}
+
+void VertexArena::Deallocate(void* ptr, std::size_t bytes)
+{
+    std::size_t index = ClassOf(bytes);
+    if (index >= CLASS_COUNT) {
+        ::operator delete(ptr);
+        return;
+    }
+    classes[index]->Deallocate(ptr);
+}
+
+VertexArena& VertexArena::Get()
+{
+    // Leaked for the same reason as the object pools, vertex lists can outlive static destruction
+    static VertexArena* arena = new VertexArena();
+    return *arena;
+}
+
+} // namespace Cad
@@ -0,0 +1,120 @@
+#include <cad/object/IntersectionIndex.h>
+#include <cad/object/PolygonSelection.h>
+#include <cad/object/SpatialIndex.h>
+#include <core/math/Geometry.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Cad {
+
+namespace {
+using Primitive = IntersectionIndex::Primitive;
+
+// A point on the outline of the piece
+Core::Vector2 OutlinePoint(const Primitive& primitive)
+{
+    return primitive.kind == Primitive::Kind::Segment ? primitive.a
+                                                      : primitive.a + Core::Vector2(std::abs(primitive.radius), 0);
+}
+
+bool Meets(const Primitive& primitive, Core::Vector2 a, Core::Vector2 b)
+{
+    auto hits = primitive.kind == Primitive::Kind::Segment
+                    ? Core::IntersectSegments(primitive.a, primitive.b, a, b)
+                    : Core::IntersectSegmentCircle(a, b, primitive.a, std::abs(primitive.radius));
+    return hits.count > 0;
+}
+
+Core::Bounds BoundsOf(const Primitive& primitive)
+{
+    if (primitive.kind == Primitive::Kind::Segment) return Core::Bounds::FromPoints(primitive.a, primitive.b);
+    return Core::Bounds(primitive.a, primitive.a).Inflated(std::abs(primitive.radius));
+}
+
+template <typename T> void AddOutline(const T& object, std::vector<Primitive>& primitives)
+{
+    IntersectionIndex::Decompose(object, primitives);
+}
+
+// The intersection index leaves hatches out, their outline for selection is the edges of their loops
+void AddOutline(const HatchObject& hatch, std::vector<Primitive>& primitives)
+{
+    for (auto& loop : hatch.loops) {
+        for (size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+            primitives.push_back(Primitive{Primitive::Kind::Segment, loop[j], loop[i], 0, hatch.GetId()});
+        }
+    }
+}
+} // namespace
+
+float PolygonWinding(const std::vector<Core::Vector2>& polygon)
+{
+    float sum = 0;
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        sum += polygon[j].x * polygon[i].y - polygon[i].x * polygon[j].y;
+    }
+    return sum;
+}
+
+std::vector<ObjectRegistry::Reference> SelectInPolygon(
+    const ObjectRegistry& registry, const std::vector<Core::Vector2>& polygon, bool crossing, LayerFilter filter)
+{
+    if (polygon.size() < 3) return {};
+
+    Core::Bounds bounds(polygon[0], polygon[0]);
+    float perimeter = 0;
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        bounds.Expand(polygon[i]);
+        perimeter += (polygon[i] - polygon[j]).Length();
+    }
+
+    // Outline pieces of every candidate, the ones of candidates[i] start at firsts[i]
+    std::vector<ObjectId> candidates;
+    std::vector<Primitive> primitives;
+    std::vector<size_t> firsts;
+    registry.Visit(bounds, filter, [&](auto& object) {
+        if (!crossing && !bounds.Contains(object.GetBounds())) return;
+        candidates.push_back(object.GetId());
+        firsts.push_back(primitives.size());
+        AddOutline(object, primitives);
+    });
+    firsts.push_back(primitives.size());
+
+    Core::PointBatch points;
+    points.x.reserve(primitives.size());
+    points.y.reserve(primitives.size());
+    for (auto& primitive : primitives) {
+        points.Add(OutlinePoint(primitive));
+    }
+    std::vector<uint32_t> inside;
+    Core::PointsInPolygon(points, polygon, inside);
+
+    // Cells about the length of an average edge
+    SpatialIndex<uint32_t> edges(std::max(perimeter / polygon.size(), 1e-6f));
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        edges.Insert(uint32_t(j), Core::Bounds::FromPoints(polygon[j], polygon[i]));
+    }
+    auto meets_edge = [&](const Primitive& primitive) {
+        bool meets = false;
+        edges.Query(BoundsOf(primitive), [&](uint32_t edge, const Core::Bounds&) {
+            meets = meets || Meets(primitive, polygon[edge], polygon[(edge + 1) % polygon.size()]);
+        });
+        return meets;
+    };
+
+    std::vector<ObjectId> matches;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        size_t first = firsts[i], last = firsts[i + 1];
+        if (first == last) continue;
+        bool match = !crossing;
+        for (size_t p = first; p < last && match != crossing; p++) {
+            bool touches = meets_edge(primitives[p]);
+            match = crossing ? touches || inside[p] : !touches && inside[p];
+        }
+        if (match) matches.push_back(candidates[i]);
+    }
+    return registry.Find(matches);
+}
+
+} // namespace Cad
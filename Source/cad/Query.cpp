@@ -0,0 +1,236 @@
+#include <cad/object/ObjectVariant.h>
+#include <cad/object/Query.h>
+
+#include <algorithm>
+
+namespace Cad {
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Query                                                        */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+Query Query::TypeIs(ObjectType type)
+{
+    Node node{Op::Type};
+    node.type = type;
+    return Query(node);
+}
+
+Query Query::LayerIs(LayerId layer)
+{
+    Node node{Op::Layer};
+    node.layer = layer;
+    return Query(node);
+}
+
+Query Query::OnLayers(LayerFilter filter)
+{
+    Node node{Op::LayerFilter};
+    node.filter = filter;
+    return Query(node);
+}
+
+Query Query::Inside(const Core::Bounds& rect)
+{
+    Node node{Op::Inside};
+    node.rect = rect;
+    return Query(node);
+}
+
+Query Query::Intersects(const Core::Bounds& rect)
+{
+    Node node{Op::Intersects};
+    node.rect = rect;
+    return Query(node);
+}
+
+Query Query::Crosses(const Core::Bounds& rect)
+{
+    Node node{Op::Crosses};
+    node.rect = rect;
+    return Query(node);
+}
+
+Query Query::LengthIn(float min, float max)
+{
+    Node node{Op::Length};
+    node.min = min;
+    node.max = max;
+    return Query(node);
+}
+
+Query Query::RadiusIn(float min, float max)
+{
+    Node node{Op::Radius};
+    node.min = min;
+    node.max = max;
+    return Query(node);
+}
+
+Query Query::operator&&(const Query& other) const
+{
+    Node node{Op::And};
+    node.left = root;
+    node.right = other.root;
+    return Query(node);
+}
+
+Query Query::operator||(const Query& other) const
+{
+    Node node{Op::Or};
+    node.left = root;
+    node.right = other.root;
+    return Query(node);
+}
+
+Query Query::operator!() const
+{
+    Node node{Op::Not};
+    node.left = root;
+    return Query(node);
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                   CompiledQuery                                                    */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+// Rect every match of the node lies in: the overlap of a conjunction's rects, the union of a disjunction's
+std::optional<Core::Bounds> RequiredRect(const Query::Node& node)
+{
+    switch (node.op) {
+    case Query::Op::Inside:
+    case Query::Op::Intersects:
+    case Query::Op::Crosses: return node.rect;
+    case Query::Op::And: {
+        auto left = RequiredRect(*node.left);
+        auto right = RequiredRect(*node.right);
+        if (left && right) return left->Intersected(*right);
+        return left ? left : right;
+    }
+    case Query::Op::Or: {
+        auto left = RequiredRect(*node.left);
+        auto right = RequiredRect(*node.right);
+        if (!left || !right) return std::nullopt;
+        return left->Expand(*right);
+    }
+    default: return std::nullopt;
+    }
+}
+
+// Same for layers
+std::optional<std::vector<bool>> RequiredLayers(const Query::Node& node, const std::vector<Layer>& layers)
+{
+    switch (node.op) {
+    case Query::Op::Layer: {
+        std::vector<bool> mask(layers.size(), false);
+        if (node.layer < layers.size()) mask[node.layer] = true;
+        return mask;
+    }
+    case Query::Op::LayerFilter: {
+        std::vector<bool> mask(layers.size());
+        for (size_t i = 0; i < layers.size(); i++) {
+            mask[i] = layers[i].Accepts(node.filter);
+        }
+        return mask;
+    }
+    case Query::Op::And:
+    case Query::Op::Or: {
+        auto left = RequiredLayers(*node.left, layers);
+        auto right = RequiredLayers(*node.right, layers);
+        bool conjunction = node.op == Query::Op::And;
+        if (!left || !right) return conjunction ? (left ? left : right) : std::nullopt;
+        for (size_t i = 0; i < layers.size(); i++) {
+            (*left)[i] = conjunction ? (*left)[i] && (*right)[i] : (*left)[i] || (*right)[i];
+        }
+        return left;
+    }
+    default: return std::nullopt;
+    }
+}
+} // namespace
+
+CompiledQuery::CompiledQuery(const Query& query, const std::vector<Layer>& layers, const IdIndex<size_t>& selection)
+    : selection(selection)
+{
+    for (auto filter : {LayerFilter::All, LayerFilter::Visible, LayerFilter::Editable}) {
+        auto& mask = accepted[size_t(filter)];
+        for (const Layer& layer : layers) {
+            mask.push_back(layer.Accepts(filter));
+        }
+    }
+
+    for (size_t type = 0; type < TYPE_COUNT; type++) {
+        programs[type] = Fold(query.GetRoot(), ObjectType(type));
+    }
+    rect = RequiredRect(query.GetRoot());
+    this->layers = RequiredLayers(query.GetRoot(), layers);
+}
+
+// Compile the node for one object type, folding whatever the type decides
+CompiledQuery::Program CompiledQuery::Fold(const Query::Node& node, ObjectType type) const
+{
+    Program program;
+    switch (node.op) {
+    case Query::Op::True: program.constant = true; return program;
+    case Query::Op::False: program.constant = false; return program;
+    case Query::Op::Type: program.constant = node.type == type; return program;
+    case Query::Op::Radius:
+        if (type != ObjectType::Circle) {
+            program.constant = false;
+            return program;
+        }
+        break;
+    case Query::Op::Not: {
+        program = Fold(*node.left, type);
+        if (program.constant) {
+            program.constant = !*program.constant;
+        } else {
+            program.code.push_back(Instruction{Query::Op::Not});
+        }
+        return program;
+    }
+    case Query::Op::And:
+    case Query::Op::Or: {
+        // A constant operand either decides the whole node or drops out of it
+        bool conjunction = node.op == Query::Op::And;
+        Program left = Fold(*node.left, type);
+        Program right = Fold(*node.right, type);
+        for (Program* operand : {&left, &right}) {
+            if (operand->constant && *operand->constant != conjunction) return *operand;
+        }
+        if (left.constant) return right;
+        if (right.constant) return left;
+
+        program.code = std::move(left.code);
+        program.code.insert(program.code.end(), right.code.begin(), right.code.end());
+        program.code.push_back(Instruction{node.op});
+        program.depth = std::max(left.depth, right.depth + 1);
+        return program;
+    }
+    default: break;
+    }
+
+    Instruction instruction{node.op, node.layer, node.rect, node.min, node.max};
+    if (node.op == Query::Op::LayerFilter) instruction.layer = LayerId(node.filter);
+    program.code.push_back(instruction);
+    program.depth = 1;
+    return program;
+}
+
+bool CompiledQuery::MayMatch() const
+{
+    if (rect && rect->IsEmpty()) return false;
+    if (layers && std::none_of(layers->begin(), layers->end(), [](bool layer) { return layer; })) return false;
+    return std::any_of(programs.begin(), programs.end(),
+        [](const Program& program) { return !program.constant || *program.constant; });
+}
+
+bool CompiledQuery::Matches(const Object& object) const
+{
+    const Program& program = programs[size_t(object.GetType())];
+    if (program.constant) return *program.constant;
+    return Dispatch(object, [this, &program](auto& concrete) { return Run(program, concrete); });
+}
+
+} // namespace Cad
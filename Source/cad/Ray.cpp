@@ -3,47 +3,36 @@
 #include <cad/object/ObjectRegistry.h>
 #include <cad/object/ObjectVisitor.h>
 
+#include <algorithm>
+#include <cmath>
+
 #define MIN_INT -2147483648
 #define MAX_INT 2147483647
 
 namespace Cad {
 
-Ray::IntersectionResult Ray::GetLineIntersection(Core::Vector2 start, Core::Vector2 end) {
-    Core::Vector2 p = origin;
-    p = p - (direction * Core::Vector2(1000, 1000));
-    Core::Vector2 r = (direction * Core::Vector2(1000, 1000)) * 2;
-
-    Core::Vector2 q = start;
+Ray::IntersectionResult Ray::GetLineIntersection(Core::Vector2 start, Core::Vector2 end) const {
     Core::Vector2 s = end - start;
-
-    float r_cross_s = r.Cross(s);
-    float q_minus_p_cross_r = (q - p).Cross(r);
-
-    if (r_cross_s == 0 && q_minus_p_cross_r == 0) {
-        // lines are collinear
-        return Ray::IntersectionResult(Ray::Intersection::Collinear);
-    }
-
-    if (r_cross_s == 0 && q_minus_p_cross_r != 0) {
-        // lines are parallel
-        return Ray::IntersectionResult(Ray::Intersection::Parallel);
-    }
-
-    float t = (q - p).Cross(s) / r_cross_s;
-    float u = (q - p).Cross(r) / r_cross_s;
-
-    if (t >= 0 && t <= 1 && u >= 0 && u <= 1) {
-        auto result = p + (r * t);
-        return Ray::IntersectionResult(result);
+    if (direction.Cross(s) == 0) {
+        // lines are collinear or parallel
+        bool collinear = (start - origin).Cross(direction) == 0;
+        return Ray::IntersectionResult(collinear ? Ray::Intersection::Collinear : Ray::Intersection::Parallel);
     }
 
-    if (t >= 0 && t <= 1) {
-        // lines intersect, but segments do not
+    auto intersections = Core::IntersectLineSegment(origin, direction, start, end);
+    if (intersections.count == 0) {
+        // lines intersect, but not within the segment
         return Ray::IntersectionResult(Ray::Intersection::None);
     }
+    return Ray::IntersectionResult(intersections.points[0]);
+}
+
+Core::Intersections Ray::GetCircleIntersections(Core::Vector2 center, float radius) const {
+    return Core::IntersectLineCircle(origin, direction, center, radius);
+}
 
-    // lines do not intersect
-    return Ray::IntersectionResult(Ray::Intersection::None);
+Core::Intersections Ray::GetRayIntersection(const Ray& other) const {
+    return Core::IntersectLines(origin, direction, other.origin, other.direction);
 }
 
 void Ray::Draw(Core::Graphics& graphics, Core::Transform view_transform) {
@@ -63,69 +52,166 @@ void Ray::Draw(Core::Graphics& graphics, Core::Transform view_transform) {
     graphics.DrawLine(color,start_x, start_y, end_x, end_y);
 }
 
-struct RaycastSnapVisitor : public ObjectVisitor {
-    std::vector<Core::Vector2> snap_vectors;
-    Core::Vector2 mouse_pos;
-    Core::Transform view_transform;
-    std::vector<Ray> rays;
-
-    RaycastSnapVisitor(std::vector<Ray> rays, Core::Transform transform, Core::Vector2 mouse_pos)
-        : rays(rays), view_transform(transform), mouse_pos(mouse_pos) {}
-
-    void Visit(LineObject& object) override {
-        // check for line intersection
-        for (auto& ray : rays) {
-            auto intersection = ray.GetLineIntersection(object.start, object.end);
-            if (intersection.intersection != Ray::Intersection::Intersecting) return;
-            auto intersection_screen = view_transform.Apply(intersection.point);
-            float distance_from_mouse = (mouse_pos - intersection_screen).Length();
-            if (distance_from_mouse < 10) {
-                snap_vectors.push_back(intersection_screen);
-            }
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                      Ray bank                                                      */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+bool ByT(const RayBank::Crossing& a, const RayBank::Crossing& b) { return a.t < b.t; }
+} // namespace
+
+RayId RayBank::AddRay(Ray ray) {
+    RayId id = next_id++;
+    for (auto& entry : entries) {
+        auto intersections = entry.ray.GetRayIntersection(ray);
+        if (intersections.count == 0) continue;
+        ray_crossings.push_back(RayCrossing{entry.id, id, intersections.points[0]});
+    }
+    entries.push_back(Entry{id, ray, {}, false});
+    revision++;
+    return id;
+}
+
+bool RayBank::RemoveRay(RayId id) {
+    auto entry = std::find_if(entries.begin(), entries.end(), [id](const Entry& entry) { return entry.id == id; });
+    if (entry == entries.end()) return false;
+    entries.erase(entry);
+    ray_crossings.erase(std::remove_if(ray_crossings.begin(), ray_crossings.end(),
+                            [id](const RayCrossing& crossing) { return crossing.a == id || crossing.b == id; }),
+        ray_crossings.end());
+    revision++;
+    return true;
+}
+
+const Ray* RayBank::FindRay(RayId id) const {
+    for (auto& entry : entries) {
+        if (entry.id == id) return &entry.ray;
+    }
+    return nullptr;
+}
+
+void RayBank::Clear() {
+    entries.clear();
+    ray_crossings.clear();
+    revision++;
+}
+
+void RayBank::Cross(Entry& entry, const Object& object) {
+    const Ray& ray = entry.ray;
+    double length_squared = double(ray.direction.x) * ray.direction.x + double(ray.direction.y) * ray.direction.y;
+    auto add = [&](const Core::Intersections& intersections) {
+        for (int i = 0; i < intersections.count; i++) {
+            Core::Vector2 point = intersections.points[i];
+            double t = (double(point.x - ray.origin.x) * ray.direction.x
+                           + double(point.y - ray.origin.y) * ray.direction.y)
+                       / length_squared;
+            entry.crossings.push_back(Crossing{t, point, object.GetId()});
+        }
+    };
+
+    scratch.clear();
+    IntersectionIndex::Decompose(object, scratch);
+    for (auto& primitive : scratch) {
+        if (primitive.kind == IntersectionIndex::Primitive::Kind::Segment) {
+            add(Core::IntersectLineSegment(ray.origin, ray.direction, primitive.a, primitive.b));
+        } else {
+            add(Core::IntersectLineCircle(ray.origin, ray.direction, primitive.a, primitive.radius));
         }
     }
+}
+
+void RayBank::Fill(Entry& entry, const ObjectRegistry& registry) {
+    entry.crossings.clear();
+    entry.crossed = true;
+    if (entry.ray.direction.x == 0 && entry.ray.direction.y == 0) return;
+
+    // Only the part of the line over the drawing can cross anything
+    Core::Bounds bounds = registry.GetBounds(LayerFilter::All);
+    if (bounds.IsEmpty()) return;
+    float extent = std::max(bounds.max.x - bounds.min.x, bounds.max.y - bounds.min.y);
+    bounds = bounds.Inflated(std::max(extent * 1e-3f, 1e-3f));
+    double t0 = -INFINITY, t1 = INFINITY;
+    if (!Core::ClipLine(entry.ray.origin, entry.ray.direction, bounds, t0, t1)) return;
+
+    Core::Vector2 a = entry.ray.origin + entry.ray.direction * float(t0);
+    Core::Vector2 b = entry.ray.origin + entry.ray.direction * float(t1);
+    registry.Visit(a, b, LayerFilter::All, [this, &entry](auto& object) { Cross(entry, object); });
+    std::sort(entry.crossings.begin(), entry.crossings.end(), ByT);
+}
 
-    void Visit(CircleObject& object) override {
-        // check for circle intersection
-        // check for circle tangent
+void RayBank::Sync(const ObjectRegistry& registry) {
+    auto& journal = registry.GetJournal();
+    if (!synced) {
+        // Nothing has been crossed yet, so there is nothing to catch up on
+        cursor = journal.GetCursor();
+        synced = true;
+        return;
     }
 
-    void Visit(PolylineObject& object) override {
-        // check for line intersection
-        // check for line tangent
-        // check for circle intersection
-        // check for circle tangent
+    std::vector<ObjectId> changed;
+    std::vector<ObjectRegistry::Reference> current;
+    bool complete = journal.Read(cursor, [&](const ObjectRegistry::Journal::Record& record) {
+        changed.push_back(record.handle);
+        if (record.type == ObjectRegistry::Journal::Type::Deleted) return;
+        auto reference = registry.Find(record.handle);
+        if (reference->NotValid()) return;
+        current.push_back(reference);
+    });
+    if (changed.empty()) return;
+
+    // Past a point it is cheaper to cross the rays against the drawing again when they are next asked about
+    if (!complete || changed.size() * 8 > registry.Count()) {
+        for (auto& entry : entries) {
+            entry.crossed = false;
+        }
+        return;
     }
 
-    std::vector<Core::Vector2> CollectResults() {
-        // return a vector of SnapVectors
-        auto result = std::move(snap_vectors);
-        snap_vectors.clear();
-        return result;
+    std::sort(changed.begin(), changed.end());
+    for (auto& entry : entries) {
+        if (!entry.crossed) continue;
+        auto& crossings = entry.crossings;
+        crossings.erase(std::remove_if(crossings.begin(), crossings.end(),
+                            [&](const Crossing& crossing) {
+                                return std::binary_search(changed.begin(), changed.end(), crossing.id);
+                            }),
+            crossings.end());
+
+        // Objects changed several times show up more than once, only cross each of them once
+        size_t kept = crossings.size();
+        std::vector<ObjectId> crossed;
+        registry.Visit(current, [&](auto& object) {
+            if (std::find(crossed.begin(), crossed.end(), object.GetId()) != crossed.end()) return;
+            crossed.push_back(object.GetId());
+            Cross(entry, object);
+        });
+        std::sort(crossings.begin() + kept, crossings.end(), ByT);
+        std::inplace_merge(crossings.begin(), crossings.begin() + kept, crossings.end(), ByT);
     }
-};
-
-std::vector<Core::Vector2> RayBank::GetSnapPoints(
-    Cad::ObjectRegistry& registry, Core::Transform view_transform, Core::Vector2 mouse_position) {
-    RaycastSnapVisitor visitor(rays, view_transform, mouse_position);
-    registry.VisitObjects(visitor);
-    auto results = visitor.CollectResults();
-    // check for any ray to ray intersections
-
-    for (auto& ray : rays) {
-        for (auto& other_ray : rays) {
-            // if (ray == other_ray) continue;
-            auto intersection = ray.GetLineIntersection(other_ray.origin, other_ray.origin + other_ray.direction);
-            if (intersection.intersection != Ray::Intersection::Intersecting) continue;
-
-            auto intersection_screen = view_transform.Apply(intersection.point);
-            float distance_from_mouse = (mouse_position - intersection_screen).Length();
-            if (distance_from_mouse < 10) {
-                results.push_back(intersection_screen);
-            }
+}
+
+std::vector<Core::Vector2> RayBank::GetSnapPoints(const Cad::ObjectRegistry& registry, const Core::Bounds& rect) {
+    Sync(registry);
+    std::vector<Core::Vector2> results;
+
+    // The crossings of each ray are ordered along it, so the ones in the rect are a contiguous run
+    for (auto& entry : entries) {
+        double t0 = -INFINITY, t1 = INFINITY;
+        if (!Core::ClipLine(entry.ray.origin, entry.ray.direction, rect, t0, t1)) continue;
+        if (!entry.crossed) Fill(entry, registry);
+
+        auto& crossings = entry.crossings;
+        auto crossing = std::lower_bound(crossings.begin(), crossings.end(), Crossing{t0, {}, NULL_ID}, ByT);
+        for (; crossing != crossings.end() && crossing->t <= t1; ++crossing) {
+            if (!rect.Contains(crossing->point)) continue;
+            if (!registry.IsAccepted(registry.LayerOf(registry.Find(crossing->id)), LayerFilter::Visible)) continue;
+            results.push_back(crossing->point);
         }
     }
 
+    for (auto& crossing : ray_crossings) {
+        if (rect.Contains(crossing.point)) results.push_back(crossing.point);
+    }
     return results;
 }
 
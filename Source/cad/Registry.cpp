@@ -1,90 +1,774 @@
+#include <cad/object/ObjectMetrics.h>
 #include <cad/object/ObjectRegistry.h>
+#include <core/math/Geometry.h>
+
+#include <algorithm>
+#include <cmath>
 
 namespace Cad {
 
-ObjectRegistry::Entry::Entry() : object(nullptr) {}
-ObjectRegistry::Entry::Entry(std::unique_ptr<Object> object) : object(std::move(object)) {}
+ObjectRegistry::Reference ObjectRegistry::Null() { return std::make_shared<ObjectRegistry::Entry>(); }
 
-void ObjectRegistry::Entry::Invalidate()
+ObjectRegistry::ObjectRegistry()
+    : table(std::make_shared<ObjectTable>()), layers(std::make_shared<std::vector<Layer>>(1, Layer("0"))),
+      layer_indexes(1)
 {
-    if (object == nullptr) return;
-    Object* ptr = object.release();
-    delete ptr;
-    object = nullptr;
 }
-Object& ObjectRegistry::Entry::GetObject() { return *object; }
-bool ObjectRegistry::Entry::NotValid() const { return object == nullptr; }
-
-ObjectRegistry::Reference ObjectRegistry::Null() { return std::make_shared<ObjectRegistry::Entry>(); }
 
 ObjectRegistry::~ObjectRegistry()
 {
+    // Outstanding references must not point at slots that no longer exist
     for (auto& reference : references) {
-        reference->Invalidate();
+        reference->index = Entry::INVALID;
     }
 
     references.clear();
+    ids.Clear();
+    selection.clear();
+    selection_slots.Clear();
 }
 
-ObjectRegistry::Reference ObjectRegistry::CreateObject(ObjectBuilder& builder)
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                   Copy-on-write                                                    */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+// The registry holds one reference to its table, chunks and objects, anything more means a snapshot shares them
+
+ObjectTable& ObjectRegistry::MutableTable()
+{
+    if (table.use_count() > 1) table = std::make_shared<ObjectTable>(*table);
+    return *table;
+}
+
+std::shared_ptr<Object>& ObjectRegistry::MutableSlot(size_t index)
+{
+    auto& chunk = MutableTable().chunks[index / ObjectChunk::CAPACITY];
+    if (chunk.use_count() > 1) chunk = std::make_shared<ObjectChunk>(*chunk);
+    return chunk->objects[index % ObjectChunk::CAPACITY];
+}
+
+Object& ObjectRegistry::Write(Entry& entry)
+{
+    auto& slot = MutableSlot(entry.index);
+    if (slot.use_count() > 1) slot = ShareObject(slot->Clone());
+    return *slot;
+}
+
+void ObjectRegistry::RemoveSlot(size_t index)
 {
-    auto object = builder.Build();
-    auto reference = std::make_shared<Entry>(std::move(object));
+    size_t last = table->count - 1;
+    if (index != last) {
+        std::shared_ptr<Object> moved = std::move(MutableSlot(last));
+        MutableSlot(index) = std::move(moved);
+        references[index] = std::move(references[last]);
+        references[index]->index = index;
+    }
+    MutableSlot(last).reset();
+    references.pop_back();
+
+    ObjectTable& storage = MutableTable();
+    storage.count--;
+    if (storage.count % ObjectChunk::CAPACITY == 0) storage.chunks.pop_back();
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Mutation                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+ObjectRegistry::Reference ObjectRegistry::Adopt(std::unique_ptr<Object> object)
+{
+    object->layer = current_layer;
+    object->id = next_id++;
+    history.RecordCreated(object->id);
+    return Place(ShareObject(std::move(object)));
+}
+
+ObjectRegistry::Reference ObjectRegistry::Place(std::shared_ptr<Object> object)
+{
+    ObjectTable& storage = MutableTable();
+    size_t index = storage.count;
+    if (index % ObjectChunk::CAPACITY == 0) {
+        storage.chunks.push_back(std::make_shared<ObjectChunk>());
+    }
+    storage.count++;
+    ObjectId id = object->id;
+    MutableSlot(index) = std::move(object);
+
+    // Entries and their control blocks come from a pool rather than one heap allocation per object
+    auto reference = std::allocate_shared<Entry>(PoolAllocator<Entry>(), index, id);
+    reference->revision = ++revision;
     references.push_back(reference);
+    ids.Insert(id, reference.get());
+    journal.Write(Journal::Type::Created, id, revision, Core::Bounds());
+    return reference;
+}
+
+ObjectRegistry::Reference ObjectRegistry::CreateObject(ObjectBuilder& builder)
+{
+    history.Begin("create");
+    auto reference = Adopt(builder.Build());
+    LayerInsert(reference.get(), current_layer, Read(*reference).GetBounds());
+    history.End();
     return reference;
 }
 
+std::vector<ObjectRegistry::Reference> ObjectRegistry::CreateObjects(std::vector<std::unique_ptr<Object>> objects)
+{
+    history.Begin("create");
+    Reserve(Count() + objects.size());
+    std::vector<Reference> created;
+    created.reserve(objects.size());
+    for (auto& object : objects) {
+        created.push_back(Adopt(std::move(object)));
+    }
+
+    LayerIndex& layer_index = layer_indexes[current_layer];
+    for (auto& reference : created) {
+        Core::Bounds bounds = Read(*reference).GetBounds();
+        layer_index.index.Insert(reference.get(), bounds);
+        if (!layer_index.bounds_dirty) layer_index.bounds.Expand(bounds);
+    }
+    history.End();
+    return created;
+}
+
+// Grows by at least double, so reserving a little more on every edit does not reallocate each time
+void ObjectRegistry::Reserve(unsigned int count)
+{
+    if (count > references.capacity()) references.reserve(std::max<size_t>(count, 2 * references.capacity()));
+    ids.Reserve(count);
+    size_t chunks = (count + ObjectChunk::CAPACITY - 1) / ObjectChunk::CAPACITY;
+    if (chunks > table->chunks.capacity()) {
+        auto& storage = MutableTable().chunks;
+        storage.reserve(std::max(chunks, 2 * storage.capacity()));
+    }
+}
+
+void ObjectRegistry::RecordModified(Reference& reference, Core::Bounds old_bounds)
+{
+    const Object& object = Read(*reference);
+    Core::Bounds new_bounds = object.GetBounds();
+    if (new_bounds != old_bounds) {
+        LayerIndex& layer = layer_indexes[object.GetLayer()];
+        layer.index.Update(reference.get(), old_bounds, new_bounds);
+        layer.bounds_dirty = true;
+    }
+    RecordRevision(reference, old_bounds);
+}
+
+void ObjectRegistry::RecordRevision(Reference& reference, Core::Bounds old_bounds)
+{
+    reference->revision = ++revision;
+    journal.Write(Journal::Type::Modified, reference->id, revision, old_bounds);
+}
+
+void ObjectRegistry::UpdateSelection(ObjectId id, bool selected)
+{
+    const size_t* slot = selection_slots.Find(id);
+    if (selected == (slot != nullptr)) return;
+    selection_revision++;
+    if (selected) {
+        selection_slots.Insert(id, selection.size());
+        selection.push_back(id);
+        return;
+    }
+
+    // Move the last ID into the hole
+    size_t hole = *slot;
+    selection_slots.Remove(id);
+    if (hole != selection.size() - 1) {
+        selection[hole] = selection.back();
+        selection_slots.Insert(selection[hole], hole);
+    }
+    selection.pop_back();
+}
+
 void ObjectRegistry::DeleteObject(ObjectRegistry::Reference reference)
 {
     if (reference->NotValid()) return;
+    ObjectId id = reference->id;
+    auto object = Take(reference);
+    history.Begin("delete");
+    history.RecordDeleted(id, std::move(object));
+    history.End();
+}
 
-    reference->Invalidate();
+void ObjectRegistry::DeleteObjects(std::vector<ObjectRegistry::Reference> refs)
+{
+    history.Begin("delete");
+    for (auto& reference : refs) {
+        DeleteObject(reference);
+    }
+    history.End();
+}
 
-    // Purge invalid references (move to a flush method?)
-    references.remove_if([](const Reference& reference) { return reference->NotValid(); });
+void ObjectRegistry::ModifyObject(ObjectRegistry::Reference reference, ObjectVisitor& visitor)
+{
+    if (reference->NotValid()) return;
+    history.Begin("modify");
+    Core::Bounds old_bounds = Read(*reference).GetBounds();
+    RecordBefore(*reference);
+    Write(*reference).Accept(visitor);
+    RecordModified(reference, old_bounds);
+    history.End();
 }
 
-void ObjectRegistry::DeleteObjects(std::vector<ObjectRegistry::Reference> refs)
+void ObjectRegistry::ModifyObjects(const std::vector<ObjectRegistry::Reference>& refs, ObjectVisitor& visitor)
+{
+    history.Begin("modify");
+    for (auto reference : refs) {
+        ModifyObject(reference, visitor);
+    }
+    history.End();
+}
+
+void ObjectRegistry::ReplaceObject(ObjectRegistry::Reference reference, std::unique_ptr<Object> object)
+{
+    if (reference->NotValid()) return;
+    history.Begin("modify");
+    const Object& current = Read(*reference);
+    Core::Bounds old_bounds = current.GetBounds();
+    object->id = current.id;
+    object->layer = current.layer;
+    RecordBefore(*reference);
+    MutableSlot(reference->index) = ShareObject(std::move(object));
+    RecordModified(reference, old_bounds);
+    history.End();
+}
+
+// Selection is not part of the undo history or the drawing, only the registry's selection set changes
+
+void ObjectRegistry::SetSelected(const std::vector<Reference>& refs, bool selected)
 {
     for (auto& reference : refs) {
-        if (reference->NotValid()) return;
+        if (reference->NotValid()) continue;
+        UpdateSelection(reference->id, selected);
+    }
+}
+
+void ObjectRegistry::Select(const std::vector<Reference>& refs) { SetSelected(refs, true); }
+
+void ObjectRegistry::Deselect(const std::vector<Reference>& refs) { SetSelected(refs, false); }
+
+void ObjectRegistry::DeselectAll() { SetSelected(GetSelected(), false); }
 
-        reference->Invalidate();
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Transforms                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+// A hatch moved without every object it was traced from no longer follows their outline
+bool LeavesBoundaries(const Object& object, const IdIndex<bool>& moved)
+{
+    if (object.GetType() != ObjectType::Hatch) return false;
+    auto& boundaries = static_cast<const HatchObject&>(object).boundaries;
+    return std::any_of(
+        boundaries.begin(), boundaries.end(), [&moved](ObjectId id) { return moved.Find(id) == nullptr; });
+}
+} // namespace
+
+void ObjectRegistry::TransformObjects(const std::vector<Reference>& refs, const Core::Matrix3& matrix)
+{
+    std::vector<Reference> targets;
+    std::vector<Core::Bounds> old_bounds;
+    std::vector<Object*> objects;
+    targets.reserve(refs.size());
+    old_bounds.reserve(refs.size());
+    objects.reserve(refs.size());
+
+    IdIndex<bool> moved;
+    moved.Reserve(refs.size());
+    for (auto& reference : refs) {
+        if (!reference->NotValid()) moved.Insert(reference->id, true);
     }
 
-    references.remove_if([](const ObjectRegistry::Reference& reference) { return reference->NotValid(); });
+    // A matrix that flattens the objects can't be inverted to undo it, their earlier versions are kept instead, as
+    // they are for hatches that lose their boundary IDs
+    history.Begin("transform");
+    bool invertible = std::abs(matrix.Determinant()) > 1e-6f;
+
+    Core::PointBatch points;
+    for (auto& reference : refs) {
+        if (reference->NotValid()) continue;
+        old_bounds.push_back(Read(*reference).GetBounds());
+        bool detached = LeavesBoundaries(Read(*reference), moved);
+        if (!invertible || detached) RecordBefore(*reference);
+        Object& object = Write(*reference);
+        if (detached) static_cast<HatchObject&>(object).boundaries.clear();
+        GatherPoints(object, points);
+        targets.push_back(reference);
+        objects.push_back(&object);
+    }
+
+    Core::TransformPoints(matrix, points);
+
+    PointScatter scatter(points, matrix);
+    for (Object* object : objects) {
+        ScatterPoints(*object, scatter);
+    }
+
+    // Take the objects out of each layer index in one sweep when they are a good share of it, one by one otherwise,
+    // and put them back with their new bounds
+    std::vector<size_t> per_layer(layer_indexes.size(), 0);
+    for (size_t i = 0; i < targets.size(); i++) {
+        per_layer[objects[i]->GetLayer()]++;
+    }
+    for (LayerId layer = 0; layer < layer_indexes.size(); layer++) {
+        if (per_layer[layer] == 0) continue;
+        LayerIndex& layer_index = layer_indexes[layer];
+        layer_index.bounds_dirty = true;
+        if (per_layer[layer] * 8 < layer_index.index.Count()) continue;
+        layer_index.index.RemoveIf([&moved](Entry* entry) { return moved.Find(entry->id) != nullptr; });
+        per_layer[layer] = 0;
+    }
+    for (size_t i = 0; i < targets.size(); i++) {
+        LayerIndex& layer_index = layer_indexes[objects[i]->GetLayer()];
+        if (per_layer[objects[i]->GetLayer()] != 0) layer_index.index.Remove(targets[i].get(), old_bounds[i]);
+        layer_index.index.Insert(targets[i].get(), objects[i]->GetBounds());
+        RecordRevision(targets[i], old_bounds[i]);
+    }
+    if (invertible && history.IsRecording()) history.RecordTransformed(GetIds(targets), matrix);
+    history.End();
 }
 
-void ObjectRegistry::VisitObjects(ObjectVisitor& visitor)
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                        Undo                                                        */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+// The history shares the version it keeps with the drawing until Write replaces the drawing's copy
+void ObjectRegistry::RecordBefore(const Entry& entry)
 {
-    for (auto& reference : references) {
-        VisitObject(reference, visitor);
+    if (!history.IsRecording()) return;
+    history.RecordModified(entry.id, table->Share(entry.index));
+}
+
+std::shared_ptr<Object> ObjectRegistry::Take(Reference reference)
+{
+    size_t index = reference->index;
+    std::shared_ptr<Object> object = table->Share(index);
+    Core::Bounds old_bounds = object->GetBounds();
+    LayerRemove(reference.get(), object->GetLayer(), old_bounds);
+    UpdateSelection(reference->id, false);
+    ids.Remove(reference->id);
+    RemoveSlot(index);
+    reference->index = Entry::INVALID;
+    reference->revision = ++revision;
+    journal.Write(Journal::Type::Deleted, reference->id, revision, old_bounds);
+    return object;
+}
+
+void ObjectRegistry::Restore(std::shared_ptr<Object> object)
+{
+    // Objects held by the history may still be shared with a snapshot, Write copies them before they are changed
+    LayerId layer = object->layer;
+    auto reference = Place(std::move(object));
+    LayerInsert(reference.get(), layer, Read(*reference).GetBounds());
+}
+
+void ObjectRegistry::Exchange(ObjectId id, std::shared_ptr<Object>& other)
+{
+    Entry* const* entry = ids.Find(id);
+    if (entry == nullptr || other == nullptr) return;
+    Reference reference = references[(*entry)->index];
+    const Object& current = Read(*reference);
+    Core::Bounds old_bounds = current.GetBounds();
+    LayerId old_layer = current.GetLayer();
+
+    std::swap(MutableSlot(reference->index), other);
+
+    const Object& restored = Read(*reference);
+    if (restored.GetLayer() == old_layer) {
+        RecordModified(reference, old_bounds);
+        return;
+    }
+    LayerRemove(reference.get(), old_layer, old_bounds);
+    LayerInsert(reference.get(), restored.GetLayer(), restored.GetBounds());
+    RecordRevision(reference, old_bounds);
+}
+
+// Undoing goes through the changes backwards and applies the opposite of each, redoing applies them again in order
+void ObjectRegistry::Replay(UndoJournal::Entry& entry, bool forward)
+{
+    using Kind = UndoJournal::Change::Kind;
+    history.Suspend(true);
+    size_t count = entry.changes.size();
+    for (size_t k = 0; k < count; k++) {
+        UndoJournal::Change& change = entry.changes[forward ? k : count - 1 - k];
+        switch (change.kind) {
+        case Kind::Created:
+        case Kind::Deleted: {
+            bool present = (change.kind == Kind::Created) == forward;
+            if (present) {
+                for (auto& object : change.objects) {
+                    if (object != nullptr) Restore(std::move(object));
+                }
+                change.objects.clear();
+                change.objects.shrink_to_fit();
+                break;
+            }
+            change.objects.clear();
+            change.objects.reserve(change.ids.size());
+            for (ObjectId id : change.ids) {
+                Entry* const* found = ids.Find(id);
+                change.objects.push_back(found == nullptr ? nullptr : Take(references[(*found)->index]));
+            }
+            break;
+        }
+        case Kind::Transformed:
+            TransformObjects(Find(change.ids), forward ? change.matrix : change.matrix.Inverse());
+            break;
+        case Kind::Modified: {
+            size_t n = change.ids.size();
+            for (size_t i = 0; i < n; i++) {
+                size_t at = forward ? i : n - 1 - i;
+                Exchange(change.ids[at], change.objects[at]);
+            }
+            break;
+        }
+        }
     }
+    history.Suspend(false);
 }
 
-void ObjectRegistry::VisitObject(ObjectRegistry::Reference reference, ObjectVisitor& visitor)
+std::optional<std::string> ObjectRegistry::Undo()
+{
+    UndoJournal::Entry entry;
+    if (history.IsPending() || !history.PopUndo(entry)) return std::nullopt;
+    Replay(entry, false);
+    std::string label = entry.label;
+    history.PushRedo(std::move(entry));
+    return label;
+}
+
+std::optional<std::string> ObjectRegistry::Redo()
+{
+    UndoJournal::Entry entry;
+    if (history.IsPending() || !history.PopRedo(entry)) return std::nullopt;
+    Replay(entry, true);
+    std::string label = entry.label;
+    history.PushUndo(std::move(entry));
+    return label;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Layers                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+std::vector<Layer>& ObjectRegistry::MutableLayers()
+{
+    if (layers.use_count() > 1) layers = std::make_shared<std::vector<Layer>>(*layers);
+    return *layers;
+}
+
+void ObjectRegistry::LayerInsert(Entry* entry, LayerId layer, const Core::Bounds& bounds)
+{
+    LayerIndex& layer_index = layer_indexes[layer];
+    layer_index.index.Insert(entry, bounds);
+    if (!layer_index.bounds_dirty) layer_index.bounds.Expand(bounds);
+}
+
+void ObjectRegistry::LayerRemove(Entry* entry, LayerId layer, const Core::Bounds& bounds)
+{
+    LayerIndex& layer_index = layer_indexes[layer];
+    layer_index.index.Remove(entry, bounds);
+    layer_index.bounds_dirty = true;
+}
+
+LayerId ObjectRegistry::CreateLayer(std::string name)
+{
+    if (auto existing = FindLayer(name)) return existing.value();
+    MutableLayers().emplace_back(std::move(name));
+    layer_indexes.emplace_back();
+    return layers->size() - 1;
+}
+
+std::optional<LayerId> ObjectRegistry::FindLayer(const std::string& name) const
+{
+    for (LayerId id = 0; id < layers->size(); id++) {
+        if ((*layers)[id].name == name) return id;
+    }
+    return std::nullopt;
+}
+
+bool ObjectRegistry::IsAccepted(LayerId layer, LayerFilter filter) const { return (*layers)[layer].Accepts(filter); }
+
+void ObjectRegistry::DeselectLayer(LayerId layer)
+{
+    std::vector<Reference> selected;
+    for (auto& reference : GetSelected()) {
+        if (LayerOf(reference) == layer) selected.push_back(reference);
+    }
+    SetSelected(selected, false);
+}
+
+// Visibility and locking don't change any object, but they do change what gets drawn and picked, so they count as a
+// new revision of the drawing
+
+void ObjectRegistry::SetLayerVisible(LayerId layer, bool visible)
+{
+    if (!visible) DeselectLayer(layer);
+    MutableLayers()[layer].visible = visible;
+    revision++;
+}
+
+void ObjectRegistry::SetLayerLocked(LayerId layer, bool locked)
+{
+    if (locked) DeselectLayer(layer);
+    MutableLayers()[layer].locked = locked;
+    revision++;
+}
+
+void ObjectRegistry::SetLayerColor(LayerId layer, Core::Pixel color)
+{
+    MutableLayers()[layer].color = color;
+    revision++;
+}
+
+void ObjectRegistry::MoveToLayer(const std::vector<Reference>& refs, LayerId layer)
+{
+    history.Begin("layer");
+    for (auto reference : refs) {
+        if (reference->NotValid() || Read(*reference).GetLayer() == layer) continue;
+        RecordBefore(*reference);
+        Object& object = Write(*reference);
+        Core::Bounds bounds = object.GetBounds();
+        LayerRemove(reference.get(), object.layer, bounds);
+        object.layer = layer;
+        LayerInsert(reference.get(), layer, bounds);
+        RecordModified(reference, bounds);
+    }
+    history.End();
+}
+
+Core::Bounds ObjectRegistry::GetLayerBounds(LayerId layer) const
+{
+    LayerIndex& layer_index = layer_indexes[layer];
+    if (layer_index.bounds_dirty) {
+        layer_index.bounds = layer_index.index.GetBounds();
+        layer_index.bounds_dirty = false;
+    }
+    return layer_index.bounds;
+}
+
+Core::Bounds ObjectRegistry::GetBounds(LayerFilter filter) const
+{
+    Core::Bounds bounds;
+    for (LayerId layer = 0; layer < layers->size(); layer++) {
+        if (IsAccepted(layer, filter)) bounds.Expand(GetLayerBounds(layer));
+    }
+    return bounds;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                       Blocks                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+void Translate(LineObject& line, Core::Vector2 delta)
+{
+    line.start += delta;
+    line.end += delta;
+}
+
+void Translate(CircleObject& circle, Core::Vector2 delta) { circle.center += delta; }
+
+void Translate(PolylineObject& polyline, Core::Vector2 delta)
+{
+    for (auto& point : polyline.points) {
+        point += delta;
+    }
+}
+
+void Translate(InsertObject& insert, Core::Vector2 delta) { insert.transform.Translate(delta.x, delta.y); }
+
+void Translate(HatchObject& hatch, Core::Vector2 delta)
+{
+    for (auto& loop : hatch.loops) {
+        for (auto& point : loop) {
+            point += delta;
+        }
+    }
+}
+} // namespace
+
+std::shared_ptr<const BlockDefinition> ObjectRegistry::DefineBlock(
+    std::string name, const std::vector<Reference>& refs, Core::Vector2 base_point)
+{
+    std::vector<ObjectVariant> objects;
+    objects.reserve(refs.size());
+    for (auto& reference : refs) {
+        if (reference->NotValid()) continue;
+        objects.push_back(ToVariant(Read(*reference)));
+        std::visit(
+            [base_point](auto& object) {
+                Translate(object, Core::Vector2(0, 0) - base_point);
+                object.layer = 0;
+                object.id = NULL_ID;
+                if constexpr (std::is_same_v<std::decay_t<decltype(object)>, HatchObject>) object.boundaries.clear();
+            },
+            objects.back());
+    }
+
+    auto block = std::make_shared<const BlockDefinition>(name, std::move(objects));
+    for (auto& existing : blocks) {
+        if (existing->name != name) continue;
+        existing = block;
+        return block;
+    }
+    blocks.push_back(block);
+    return block;
+}
+
+std::shared_ptr<const BlockDefinition> ObjectRegistry::FindBlock(const std::string& name) const
+{
+    for (auto& block : blocks) {
+        if (block->name == name) return block;
+    }
+    return nullptr;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                      Reading                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+void ObjectRegistry::VisitObjects(ConstObjectVisitor& visitor) const { table->VisitObjects(visitor); }
+
+void ObjectRegistry::VisitObject(ObjectRegistry::Reference reference, ConstObjectVisitor& visitor) const
 {
     if (reference->NotValid()) return;
-    reference->GetObject().Accept(visitor);
+    Read(*reference).Accept(visitor);
 }
 
-void ObjectRegistry::VisitObjects(std::vector<ObjectRegistry::Reference> refs, ObjectVisitor& visitor)
+void ObjectRegistry::VisitObjects(const std::vector<ObjectRegistry::Reference>& refs, ConstObjectVisitor& visitor) const
 {
     for (auto& reference : refs) {
         VisitObject(reference, visitor);
     }
 }
 
-std::vector<ObjectRegistry::Reference> ObjectRegistry::QueryObjects(ObjectPredicate& predicate)
+std::vector<ObjectRegistry::Reference> ObjectRegistry::QueryObjects(ObjectPredicate& predicate) const
 {
     std::vector<Reference> result;
-    for (auto& reference : references) {
-        if (predicate.Match(reference->GetObject())) {
-            result.push_back(reference);
+    for (size_t i = 0; i < table->count; i++) {
+        if (predicate.Match(table->Get(i))) {
+            result.push_back(references[i]);
         }
     }
     return result;
 }
 
-unsigned int ObjectRegistry::Count() const { return references.size(); }
+std::vector<ObjectRegistry::Reference> ObjectRegistry::QueryObjects(const Query& query) const
+{
+    std::vector<Reference> result;
+    CompiledQuery compiled = Compile(query);
+    if (!compiled.MayMatch()) return result;
+
+    if (auto rect = compiled.GetRect()) {
+        for (LayerId layer = 0; layer < layers->size(); layer++) {
+            if (!compiled.MayMatch(layer) || !GetLayerBounds(layer).Intersects(*rect)) continue;
+            layer_indexes[layer].index.Query(*rect, [&](Entry* entry, const Core::Bounds&) {
+                if (compiled.Matches(Read(*entry))) result.push_back(references[entry->index]);
+            });
+        }
+        return result;
+    }
+
+    for (size_t i = 0; i < table->count; i++) {
+        if (compiled.Matches(table->Get(i))) result.push_back(references[i]);
+    }
+    return result;
+}
+
+void ObjectRegistry::VisitObjects(ConstObjectVisitor& visitor, LayerFilter filter) const
+{
+    for (LayerId layer = 0; layer < layers->size(); layer++) {
+        if (!IsAccepted(layer, filter)) continue;
+        layer_indexes[layer].index.ForEach(
+            [this, &visitor](Entry* entry, const Core::Bounds&) { Read(*entry).Accept(visitor); });
+    }
+}
+
+void ObjectRegistry::VisitObjects(const Core::Bounds& rect, ConstObjectVisitor& visitor, LayerFilter filter) const
+{
+    for (LayerId layer = 0; layer < layers->size(); layer++) {
+        if (!IsAccepted(layer, filter)) continue;
+        if (!GetLayerBounds(layer).Intersects(rect)) continue;
+        layer_indexes[layer].index.Query(
+            rect, [this, &visitor](Entry* entry, const Core::Bounds&) { Read(*entry).Accept(visitor); });
+    }
+}
+
+std::vector<ObjectRegistry::Reference> ObjectRegistry::QueryObjects(const Core::Bounds& rect, LayerFilter filter) const
+{
+    std::vector<Reference> result;
+    for (LayerId layer = 0; layer < layers->size(); layer++) {
+        if (!IsAccepted(layer, filter)) continue;
+        if (!GetLayerBounds(layer).Intersects(rect)) continue;
+        layer_indexes[layer].index.Query(
+            rect, [this, &result](Entry* entry, const Core::Bounds&) { result.push_back(references[entry->index]); });
+    }
+    return result;
+}
+
+ObjectRegistry::Reference ObjectRegistry::Pick(Core::Vector2 point, float tolerance, LayerFilter filter) const
+{
+    Core::Bounds rect = Core::Bounds(point, point).Inflated(tolerance);
+    Entry* nearest = nullptr;
+    float nearest_distance = tolerance;
+    for (LayerId layer = 0; layer < layers->size(); layer++) {
+        if (!IsAccepted(layer, filter)) continue;
+        if (!GetLayerBounds(layer).Intersects(rect)) continue;
+        layer_indexes[layer].index.Query(rect, [&](Entry* entry, const Core::Bounds&) {
+            float distance = ObjectDistance(Read(*entry), point);
+            if (distance > nearest_distance || (nearest != nullptr && distance == nearest_distance)) return;
+            nearest = entry;
+            nearest_distance = distance;
+        });
+    }
+    return nearest == nullptr ? Null() : references[nearest->index];
+}
+
+std::vector<ObjectRegistry::Reference> ObjectRegistry::QueryObjects(
+    const Core::Bounds& rect, ObjectPredicate& predicate, LayerFilter filter) const
+{
+    std::vector<Reference> result;
+    for (LayerId layer = 0; layer < layers->size(); layer++) {
+        if (!IsAccepted(layer, filter)) continue;
+        if (!GetLayerBounds(layer).Intersects(rect)) continue;
+        layer_indexes[layer].index.Query(rect, [&](Entry* entry, const Core::Bounds&) {
+            if (predicate.Match(Read(*entry))) result.push_back(references[entry->index]);
+        });
+    }
+    return result;
+}
+
+ObjectRegistry::Reference ObjectRegistry::Find(ObjectId id) const
+{
+    Entry* const* entry = ids.Find(id);
+    return entry == nullptr ? Null() : references[(*entry)->index];
+}
+
+std::vector<ObjectRegistry::Reference> ObjectRegistry::Find(const std::vector<ObjectId>& ids) const
+{
+    std::vector<Reference> result;
+    result.reserve(ids.size());
+    for (ObjectId id : ids) {
+        result.push_back(Find(id));
+    }
+    return result;
+}
+
+std::vector<ObjectId> ObjectRegistry::GetIds(const std::vector<Reference>& refs) const
+{
+    std::vector<ObjectId> result;
+    result.reserve(refs.size());
+    for (auto& reference : refs) {
+        result.push_back(reference->id);
+    }
+    return result;
+}
+
+RegistrySnapshot ObjectRegistry::Snapshot() const { return RegistrySnapshot(table, layers, revision); }
+
+unsigned int ObjectRegistry::Count() const { return table->count; }
 }; // namespace Cad::Core
@@ -7,6 +7,8 @@ std::unique_ptr<Reticle> Reticle::FromType(ReticleType type) {
     case ReticleType::Midpoint: return std::make_unique<MidpointReticle>();
     case ReticleType::Endpoint: return std::make_unique<EndpointReticle>();
     case ReticleType::Intersection: return std::make_unique<IntersectionReticle>();
+    case ReticleType::Center: return std::make_unique<CenterReticle>();
+    case ReticleType::Quadrant: return std::make_unique<QuadrantReticle>();
     default: return std::make_unique<GridpointReticle>(); ;
     }
 }
@@ -73,4 +75,24 @@ void IntersectionReticle::Draw(Core::Controller& controller, Core::Vector2 scree
     graphics.DrawLine(
         Core::Color::GREEN, screen_point.x + 3, screen_point.y - 3, screen_point.x - 3, screen_point.y + 3);
 }
+
+void CenterReticle::Draw(Core::Controller& controller, Core::Vector2 screen_point)
+{
+    Reticle::Draw(controller, screen_point);
+
+    auto& graphics = controller.GetGraphics();
+    graphics.DrawCircle(Core::Color::GREEN, screen_point.x, screen_point.y, 3);
+}
+
+void QuadrantReticle::Draw(Core::Controller& controller, Core::Vector2 screen_point)
+{
+    Reticle::Draw(controller, screen_point);
+
+    auto& graphics = controller.GetGraphics();
+    // Draw a diamond around the quadrant point
+    graphics.DrawLine(Core::Color::GREEN, screen_point.x - 3, screen_point.y, screen_point.x, screen_point.y - 3);
+    graphics.DrawLine(Core::Color::GREEN, screen_point.x, screen_point.y - 3, screen_point.x + 3, screen_point.y);
+    graphics.DrawLine(Core::Color::GREEN, screen_point.x + 3, screen_point.y, screen_point.x, screen_point.y + 3);
+    graphics.DrawLine(Core::Color::GREEN, screen_point.x, screen_point.y + 3, screen_point.x - 3, screen_point.y);
+}
 } // namespace Cad
\ No newline at end of file
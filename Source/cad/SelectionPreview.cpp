@@ -0,0 +1,100 @@
+#include <cad/SelectionPreview.h>
+#include <cad/object/Block.h>
+#include <cad/object/ObjectVisitor.h>
+#include <core/graphics/ImageGraphics.h>
+
+#include <cmath>
+
+namespace Cad {
+
+namespace {
+struct PreviewVisitor : public ConstObjectVisitor {
+    Core::Graphics& graphics;
+
+    PreviewVisitor(Core::Graphics& graphics) : graphics(graphics) {}
+
+    void Visit(const LineObject& object) override {
+        graphics.DrawLine(Core::Color::BROWN, object.start.x, object.start.y, object.end.x, object.end.y);
+    }
+
+    void Visit(const CircleObject& object) override {
+        graphics.DrawCircle(Core::Color::BROWN, object.center.x, object.center.y, object.radius);
+    }
+
+    void Visit(const PolylineObject& object) override {
+        auto& points = object.points;
+        for (size_t i = 1; i < points.size(); i++) {
+            graphics.DrawLine(Core::Color::BROWN, points[i - 1].x, points[i - 1].y, points[i].x, points[i].y);
+        }
+    }
+
+    // Only the outline, the pattern is drawn once the hatch is put down
+    void Visit(const HatchObject& object) override {
+        for (auto& loop : object.loops) {
+            for (size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+                graphics.DrawLine(Core::Color::BROWN, loop[j].x, loop[j].y, loop[i].x, loop[i].y);
+            }
+        }
+    }
+
+    void Visit(const InsertObject& object) override {
+        graphics.PushTransform(graphics.GetTransform() * object.transform);
+        object.block->VisitObjects(*this);
+        graphics.PopTransform();
+    }
+};
+} // namespace
+
+void SelectionPreview::Capture(Cad::Controller& controller, Core::Vector2 delta)
+{
+    auto& graphics = controller.GetGraphics();
+    auto& registry = controller.GetRegistry();
+    view = controller.GetViewfinder().GetViewTransform();
+    revision = registry.GetRevision();
+    selection_revision = registry.GetSelectionRevision();
+
+    unsigned width = graphics.GetWidth();
+    unsigned height = graphics.GetHeight();
+    if (image == nullptr || image->GetWidth() != 3 * width || image->GetHeight() != 3 * height) {
+        image = std::make_unique<Core::Image>(3 * width, 3 * height);
+    }
+    image->Clear(Core::Pixel(0, 0, 0, 0));
+
+    // The part of the selection the offset brings on screen, with a screen to spare on every side
+    Core::Transform inverse = view.Inverse();
+    origin = inverse.Apply(Core::Vector2(-float(width), -float(height))) - delta;
+    Core::Bounds region =
+        Core::Bounds::FromPoints(origin, inverse.Apply(Core::Vector2(2.0f * width, 2.0f * height)) - delta);
+
+    Core::ImageGraphics offscreen(*image);
+    Core::Vector2 corner = view.Apply(origin);
+    offscreen.PushTransform(Core::Transform(view.x - corner.x, view.y - corner.y, view.scale, view.rotation));
+    PreviewVisitor visitor(offscreen);
+    registry.Visit(registry.GetSelected(), [&region, &visitor](auto& object) {
+        if (region.Intersects(object.GetBounds())) object.Accept(visitor);
+    });
+    offscreen.PopTransform();
+}
+
+void SelectionPreview::Draw(Cad::Controller& controller, Core::Vector2 delta)
+{
+    auto& graphics = controller.GetGraphics();
+    Core::Transform current = controller.GetViewfinder().GetViewTransform();
+    auto& registry = controller.GetRegistry();
+    bool stale = image == nullptr || current.scale != view.scale || current.rotation != view.rotation ||
+                 registry.GetRevision() != revision || registry.GetSelectionRevision() != selection_revision;
+
+    // Panning only moves the image, but once the drag has used up the margin part of the screen would be left empty
+    Core::Vector2 position = current.Apply(origin + delta);
+    if (!stale) {
+        stale = position.x > 0 || position.y > 0 || position.x + image->GetWidth() < graphics.GetWidth() ||
+                position.y + image->GetHeight() < graphics.GetHeight();
+    }
+    if (stale) {
+        Capture(controller, delta);
+        position = current.Apply(origin + delta);
+    }
+    graphics.BlitImage(*image, std::lround(position.x), std::lround(position.y));
+}
+
+} // namespace Cad
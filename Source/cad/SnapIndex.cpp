@@ -0,0 +1,226 @@
+#include <cad/object/SnapIndex.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace Cad {
+
+namespace {
+constexpr size_t MAX_PENDING = 1024;
+} // namespace
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    Maintenance                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+void SnapIndex::Collect(const Object& object, std::vector<Candidate>& candidates)
+{
+    ObjectId id = object.GetId();
+    switch (object.GetType()) {
+    case ObjectType::Line: {
+        auto& line = static_cast<const LineObject&>(object);
+        candidates.push_back(Candidate{line.start, Kind::Endpoint, id});
+        candidates.push_back(Candidate{line.end, Kind::Endpoint, id});
+        candidates.push_back(Candidate{(line.start + line.end) / 2, Kind::Midpoint, id});
+        break;
+    }
+    case ObjectType::Circle: {
+        auto& circle = static_cast<const CircleObject&>(object);
+        candidates.push_back(Candidate{circle.center, Kind::Center, id});
+        for (Core::Vector2 offset : {Core::Vector2(circle.radius, 0), Core::Vector2(0, circle.radius),
+                 Core::Vector2(-circle.radius, 0), Core::Vector2(0, -circle.radius)}) {
+            candidates.push_back(Candidate{circle.center + offset, Kind::Quadrant, id});
+        }
+        break;
+    }
+    case ObjectType::Polyline: {
+        auto& polyline = static_cast<const PolylineObject&>(object);
+        for (size_t i = 0; i < polyline.points.size(); i++) {
+            candidates.push_back(Candidate{polyline.points[i], Kind::Endpoint, id});
+            if (i == 0) continue;
+            candidates.push_back(Candidate{(polyline.points[i - 1] + polyline.points[i]) / 2, Kind::Midpoint, id});
+        }
+        break;
+    }
+    case ObjectType::Insert: {
+        auto& insert = static_cast<const InsertObject&>(object);
+        candidates.push_back(Candidate{Core::Vector2(insert.transform.x, insert.transform.y), Kind::Endpoint, id});
+        break;
+    }
+    default: break;
+    }
+}
+
+void SnapIndex::Add(const Object& object)
+{
+    size_t first = candidates.size();
+    Collect(object, candidates);
+    if (candidates.size() == first) return;
+
+    std::vector<uint32_t> slots(candidates.size() - first);
+    std::iota(slots.begin(), slots.end(), uint32_t(first));
+    by_object.Insert(object.GetId(), std::move(slots));
+}
+
+void SnapIndex::Remove(ObjectId id)
+{
+    const std::vector<uint32_t>* slots = by_object.Find(id);
+    if (slots == nullptr) return;
+    for (uint32_t slot : *slots) {
+        candidates[slot].owner = NULL_ID;
+    }
+    removed += slots->size();
+    by_object.Remove(id);
+}
+
+namespace {
+void BuildRange(std::vector<uint32_t>& tree, const std::vector<SnapIndex::Candidate>& candidates, size_t begin,
+    size_t end, int depth)
+{
+    if (end - begin < 2) return;
+    size_t middle = (begin + end) / 2;
+    std::nth_element(tree.begin() + begin, tree.begin() + middle, tree.begin() + end, [&](uint32_t a, uint32_t b) {
+        return depth % 2 == 0 ? candidates[a].point.x < candidates[b].point.x
+                              : candidates[a].point.y < candidates[b].point.y;
+    });
+    BuildRange(tree, candidates, begin, middle, depth + 1);
+    BuildRange(tree, candidates, middle + 1, end, depth + 1);
+}
+} // namespace
+
+void SnapIndex::Build()
+{
+    if (removed > 0) {
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                             [](const Candidate& candidate) { return candidate.owner == NULL_ID; }),
+            candidates.end());
+        removed = 0;
+
+        // Every slot has moved, the candidates of an object are still next to each other
+        by_object.Clear();
+        for (size_t slot = 0; slot < candidates.size(); slot++) {
+            std::vector<uint32_t>* slots = by_object.Find(candidates[slot].owner);
+            if (slots == nullptr) {
+                by_object.Insert(candidates[slot].owner, {});
+                slots = by_object.Find(candidates[slot].owner);
+            }
+            slots->push_back(uint32_t(slot));
+        }
+    }
+
+    tree.resize(candidates.size());
+    std::iota(tree.begin(), tree.end(), 0);
+    BuildRange(tree, candidates, 0, tree.size(), 0);
+    built = candidates.size();
+}
+
+void SnapIndex::Rebuild(const ObjectRegistry& registry)
+{
+    candidates.clear();
+    removed = 0;
+    by_object.Clear();
+    by_object.Reserve(registry.Count());
+    registry.Visit([this](auto& object) { Add(object); });
+    Build();
+}
+
+void SnapIndex::Sync(const ObjectRegistry& registry)
+{
+    auto& journal = registry.GetJournal();
+    if (!synced) {
+        cursor = journal.GetCursor();
+        Rebuild(registry);
+        synced = true;
+        return;
+    }
+
+    // Re-adding reads the object as it is now, so replaying several records for the same object is harmless
+    bool complete = journal.Read(cursor, [this, &registry](const ObjectRegistry::Journal::Record& record) {
+        Remove(record.handle);
+        if (record.type == ObjectRegistry::Journal::Type::Deleted) return;
+        auto reference = registry.Find(record.handle);
+        if (reference->NotValid()) return;
+        registry.Visit(std::vector<ObjectRegistry::Reference>{reference}, [this](auto& object) { Add(object); });
+    });
+    if (!complete) {
+        Rebuild(registry);
+        return;
+    }
+
+    // Keep the linear part of a search to a few microseconds and the dead weight in the tree to a quarter of it
+    if (candidates.size() - built > MAX_PENDING || removed > candidates.size() / 4) Build();
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                      Queries                                                       */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+namespace {
+// Bounded max heap of the best candidates so far, its top is the one to give up first
+struct NearestSearch {
+    const std::vector<SnapIndex::Candidate>& candidates;
+    const std::vector<uint32_t>& tree;
+    const std::function<bool(const SnapIndex::Candidate&)>& accept;
+    Core::Vector2 point;
+    float radius_squared;
+    size_t k;
+    std::vector<std::pair<float, uint32_t>> heap;
+
+    float Bound() const { return heap.size() == k ? heap.front().first : radius_squared; }
+
+    void Offer(uint32_t slot)
+    {
+        const SnapIndex::Candidate& candidate = candidates[slot];
+        if (candidate.owner == NULL_ID) return;
+        Core::Vector2 delta = candidate.point - point;
+        float distance = delta.x * delta.x + delta.y * delta.y;
+        if (distance > Bound() || (heap.size() == k && distance == Bound())) return;
+        if (accept && !accept(candidate)) return;
+
+        heap.emplace_back(distance, slot);
+        std::push_heap(heap.begin(), heap.end());
+        if (heap.size() <= k) return;
+        std::pop_heap(heap.begin(), heap.end());
+        heap.pop_back();
+    }
+
+    void Descend(size_t begin, size_t end, int depth)
+    {
+        if (begin >= end) return;
+        size_t middle = (begin + end) / 2;
+        Offer(tree[middle]);
+
+        Core::Vector2 split = candidates[tree[middle]].point;
+        float delta = depth % 2 == 0 ? point.x - split.x : point.y - split.y;
+        // Search the side the point is on first, the other one only if the splitting line is close enough
+        if (delta < 0) {
+            Descend(begin, middle, depth + 1);
+            if (delta * delta <= Bound()) Descend(middle + 1, end, depth + 1);
+        } else {
+            Descend(middle + 1, end, depth + 1);
+            if (delta * delta <= Bound()) Descend(begin, middle, depth + 1);
+        }
+    }
+};
+} // namespace
+
+std::vector<SnapIndex::Candidate> SnapIndex::Nearest(Core::Vector2 point, float radius, size_t k,
+    const std::function<bool(const Candidate&)>& accept) const
+{
+    std::vector<Candidate> result;
+    if (k == 0) return result;
+
+    NearestSearch search{candidates, tree, accept, point, radius * radius, k, {}};
+    search.Descend(0, built, 0);
+    for (size_t slot = built; slot < candidates.size(); slot++) {
+        search.Offer(uint32_t(slot));
+    }
+
+    std::sort_heap(search.heap.begin(), search.heap.end());
+    for (auto& [distance, slot] : search.heap) {
+        result.push_back(candidates[slot]);
+    }
+    return result;
+}
+
+} // namespace Cad
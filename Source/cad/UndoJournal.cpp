@@ -0,0 +1,185 @@
+#include <cad/object/ObjectVariant.h>
+#include <cad/object/UndoJournal.h>
+
+#include <type_traits>
+
+namespace Cad {
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Recording                                                      */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+void UndoJournal::Begin(std::string label, bool amend)
+{
+    if (depth++ > 0) return;
+    // Amending after an undo would fold the new changes into an entry from before the undone ones
+    if (amend && !suspended && redo.empty() && !undo.empty() && undo.back().label == label) {
+        PopUndo(pending);
+        held.Clear();
+        Change& last = pending.changes.back();
+        if (last.kind != Change::Kind::Modified) return;
+        for (ObjectId id : last.ids) {
+            held.Insert(id, true);
+        }
+        return;
+    }
+    pending.label = std::move(label);
+}
+
+void UndoJournal::End()
+{
+    if (depth == 0 || --depth > 0) return;
+    Entry entry = std::move(pending);
+    pending = Entry();
+    held.Clear();
+    if (entry.changes.empty()) return;
+
+    // A new edit is a different future from the one the redo stack leads to
+    for (auto& undone : redo) {
+        used -= undone.bytes;
+    }
+    redo.clear();
+    PushUndo(std::move(entry));
+}
+
+UndoJournal::Change& UndoJournal::Extend(Change::Kind kind)
+{
+    auto& changes = pending.changes;
+    if (changes.empty() || changes.back().kind != kind) {
+        changes.emplace_back();
+        changes.back().kind = kind;
+        held.Clear();
+    }
+    return changes.back();
+}
+
+void UndoJournal::RecordCreated(ObjectId id)
+{
+    if (!IsRecording()) return;
+    Extend(Change::Kind::Created).ids.push_back(id);
+}
+
+void UndoJournal::RecordDeleted(ObjectId id, std::shared_ptr<Object> object)
+{
+    if (!IsRecording()) return;
+    Change& change = Extend(Change::Kind::Deleted);
+    change.ids.push_back(id);
+    change.objects.push_back(std::move(object));
+}
+
+void UndoJournal::RecordTransformed(std::vector<ObjectId> ids, const Core::Matrix3& matrix)
+{
+    if (!IsRecording() || ids.empty()) return;
+    auto& changes = pending.changes;
+    if (!changes.empty() && changes.back().kind == Change::Kind::Transformed && changes.back().ids == ids) {
+        changes.back().matrix = matrix * changes.back().matrix;
+        return;
+    }
+    changes.emplace_back();
+    changes.back().kind = Change::Kind::Transformed;
+    changes.back().ids = std::move(ids);
+    changes.back().matrix = matrix;
+    held.Clear();
+}
+
+void UndoJournal::RecordModified(ObjectId id, std::shared_ptr<Object> before)
+{
+    if (!IsRecording()) return;
+    Change& change = Extend(Change::Kind::Modified);
+    if (held.Find(id) != nullptr) return;
+    held.Insert(id, true);
+    change.ids.push_back(id);
+    change.objects.push_back(std::move(before));
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                      Stacks                                                        */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+bool UndoJournal::PopUndo(Entry& entry)
+{
+    if (undo.empty()) return false;
+    entry = std::move(undo.back());
+    undo.pop_back();
+    used -= entry.bytes;
+    return true;
+}
+
+bool UndoJournal::PopRedo(Entry& entry)
+{
+    if (redo.empty()) return false;
+    entry = std::move(redo.back());
+    redo.pop_back();
+    used -= entry.bytes;
+    return true;
+}
+
+void UndoJournal::Push(std::deque<Entry>& stack, Entry entry)
+{
+    // Undoing can change what an entry holds, a created object's payload only exists while it is undone
+    entry.bytes = EstimateBytes(entry);
+    used += entry.bytes;
+    stack.push_back(std::move(entry));
+    Trim();
+}
+
+void UndoJournal::Trim()
+{
+    while (used > budget && undo.size() > 1) {
+        used -= undo.front().bytes;
+        undo.pop_front();
+    }
+    while (used > budget && !redo.empty()) {
+        used -= redo.front().bytes;
+        redo.pop_front();
+    }
+}
+
+void UndoJournal::SetBudget(size_t bytes)
+{
+    budget = bytes;
+    Trim();
+}
+
+void UndoJournal::Clear()
+{
+    undo.clear();
+    redo.clear();
+    pending = Entry();
+    held.Clear();
+    used = 0;
+}
+
+namespace {
+size_t ObjectBytes(const Object& object)
+{
+    return Dispatch(object, [](auto& concrete) {
+        size_t bytes = sizeof(concrete);
+        if constexpr (std::is_same_v<std::decay_t<decltype(concrete)>, PolylineObject>) {
+            bytes += concrete.points.capacity() * sizeof(Core::Vector2);
+        }
+        if constexpr (std::is_same_v<std::decay_t<decltype(concrete)>, HatchObject>) {
+            for (auto& loop : concrete.loops) {
+                bytes += sizeof(loop) + loop.capacity() * sizeof(Core::Vector2);
+            }
+            bytes += concrete.boundaries.capacity() * sizeof(ObjectId);
+        }
+        return bytes;
+    });
+}
+} // namespace
+
+size_t UndoJournal::EstimateBytes(const Entry& entry)
+{
+    size_t bytes = sizeof(Entry) + entry.label.capacity();
+    for (auto& change : entry.changes) {
+        bytes += sizeof(Change) + change.ids.capacity() * sizeof(ObjectId);
+        bytes += change.objects.capacity() * sizeof(std::shared_ptr<Object>);
+        for (auto& object : change.objects) {
+            if (object != nullptr) bytes += ObjectBytes(*object);
+        }
+    }
+    return bytes;
+}
+
+} // namespace Cad
@@ -34,7 +34,8 @@ Core::Vector2 Viewfinder::GetCursor(Core::Controller& controller)
     return vector;
 }
 
-void Viewfinder::Update(Core::Controller& controller, ObjectRegistry& registry, RayBank& ray_bank)
+void Viewfinder::Update(Core::Controller& controller, ObjectRegistry& registry, RayBank& ray_bank,
+    const SnapIndex& snaps, const IntersectionIndex& intersections)
 {
     Core::Input& input = controller.GetInput();
     Core::Graphics& graphics = controller.GetGraphics();
@@ -66,7 +67,7 @@ void Viewfinder::Update(Core::Controller& controller, ObjectRegistry& registry,
     } else {
         cursor->SetGridSnapped(false);
     }
-    cursor->Update(controller, registry, view_transform, grid_size, ray_bank);
+    cursor->Update(controller, registry, view_transform, grid_size, ray_bank, snaps, intersections);
 }
 
 void Viewfinder::Render(Core::Controller& controller, ObjectRegistry& registry, RayBank& ray_bank)
@@ -11,6 +11,9 @@ void Graphics::PopTransform() {
     if (m_transform_stack.empty()) return;
     m_transform_stack.pop();
 }
+Transform Graphics::GetTransform() const {
+    return m_transform_stack.empty() ? Transform::Identity() : m_transform_stack.top();
+}
 bool Graphics::IsTransformed() const { return m_is_transformed; }
 void Graphics::SetTransformed(bool is_transformed) { m_is_transformed = is_transformed; }
 bool Graphics::HasClip() { return m_clip_stack.size() > 0; }
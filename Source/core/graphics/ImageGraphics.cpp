@@ -1,6 +1,9 @@
 
 #include <core/graphics/ImageGraphics.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace Core {
 
 ImageGraphics::ImageGraphics(Image& image) : Graphics(), m_image(image) {}
@@ -212,6 +215,29 @@ void ImageGraphics::DrawImage(Image& image, float x, float y, float width, float
     }
 }
 
+void ImageGraphics::BlitImage(Image& image, int x, int y) {
+    int left = std::max(x, 0);
+    int top = std::max(y, 0);
+    int right = std::min(x + int(image.GetWidth()), int(GetWidth()));
+    int bottom = std::min(y + int(image.GetHeight()), int(GetHeight()));
+    if (HasClip()) {
+        auto clip = m_clip_stack.top();
+        left = std::max(left, int(clip.first.x));
+        top = std::max(top, int(clip.first.y));
+        right = std::min(right, int(clip.first.x + clip.second.x) + 1);
+        bottom = std::min(bottom, int(clip.first.y + clip.second.y) + 1);
+    }
+
+    const Pixel* source = reinterpret_cast<const Pixel*>(image.GetData());
+    Pixel* target = reinterpret_cast<Pixel*>(m_image.GetData());
+    for (int row = top; row < bottom; row++) {
+        const Pixel* from = source + size_t(row - y) * image.GetWidth() + (left - x);
+        Pixel* to = target + size_t(row) * GetWidth();
+        for (int column = left; column < right; column++, from++) {
+            if (from->a > 0) to[column] = *from;
+        }
+    }
+}
 
 void ImageGraphics::FillRect(Pixel color, unsigned x_in, unsigned y_in, unsigned w_in, unsigned h_in) {
     auto transform = IsTransformed() && !m_transform_stack.empty() ? m_transform_stack.top() : Transform::Identity();
@@ -301,6 +327,44 @@ void ImageGraphics::FillTriangle(Pixel color, float x0_in, float y0_in, float x1
     SetTransformed(true);
 }
 
+// Pixels are sampled at their centers, one scanline per row, and each span is written straight into the row
+void ImageGraphics::FillPolygon(Pixel color, const std::vector<std::vector<Vector2>>& contours, FillRule rule) {
+    auto transform = IsTransformed() && !m_transform_stack.empty() ? m_transform_stack.top() : Transform::Identity();
+    std::vector<std::vector<Vector2>> screen(contours.size());
+    float low = INFINITY, high = -INFINITY;
+    for (size_t i = 0; i < contours.size(); i++) {
+        screen[i].reserve(contours[i].size());
+        for (const Vector2& point : contours[i]) {
+            screen[i].push_back(transform.Apply(point));
+            low = std::min(low, screen[i].back().y);
+            high = std::max(high, screen[i].back().y);
+        }
+    }
+
+    int left = 0, top = 0, right = GetWidth(), bottom = GetHeight();
+    if (HasClip()) {
+        auto clip = m_clip_stack.top();
+        left = std::max(left, int(clip.first.x));
+        top = std::max(top, int(clip.first.y));
+        right = std::min(right, int(clip.first.x + clip.second.x) + 1);
+        bottom = std::min(bottom, int(clip.first.y + clip.second.y) + 1);
+    }
+    if (!(low < high)) return;
+    top = std::max(top, int(std::floor(low)));
+    bottom = std::min(bottom, int(std::ceil(high)));
+    if (top >= bottom || left >= right) return;
+
+    Pixel* target = reinterpret_cast<Pixel*>(m_image.GetData());
+    ScanPolygon(screen, rule, top + 0.5f, 1, bottom - top, [&](float y, float x0, float x1) {
+        int from = std::max(left, int(std::ceil(x0 - 0.5f)));
+        int to = std::min(right, int(std::ceil(x1 - 0.5f)));
+        Pixel* row = target + size_t(y) * GetWidth();
+        for (int column = from; column < to; column++) {
+            row[column] = color;
+        }
+    });
+}
+
 unsigned ImageGraphics::GetWidth() const { return m_image.GetWidth(); }
 
 unsigned ImageGraphics::GetHeight() const { return m_image.GetHeight(); }
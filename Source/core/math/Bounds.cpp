@@ -0,0 +1,63 @@
+#include <core/math/Bounds.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace Core {
+
+Bounds::Bounds() {
+    float inf = std::numeric_limits<float>::infinity();
+    min = Vector2(inf, inf);
+    max = Vector2(-inf, -inf);
+}
+
+Bounds::Bounds(Vector2 min, Vector2 max) : min(min), max(max) {}
+
+Bounds Bounds::FromPoints(Vector2 a, Vector2 b) {
+    Bounds bounds;
+    bounds.Expand(a);
+    bounds.Expand(b);
+    return bounds;
+}
+
+Bounds& Bounds::Expand(Vector2 point) {
+    min = Vector2(std::min(min.x, point.x), std::min(min.y, point.y));
+    max = Vector2(std::max(max.x, point.x), std::max(max.y, point.y));
+    return *this;
+}
+
+Bounds& Bounds::Expand(const Bounds& other) {
+    if (other.IsEmpty()) return *this;
+    Expand(other.min);
+    Expand(other.max);
+    return *this;
+}
+
+Bounds Bounds::Inflated(float amount) const {
+    if (IsEmpty()) return *this;
+    return Bounds(min - amount, max + amount);
+}
+
+Bounds Bounds::Intersected(const Bounds& other) const {
+    Bounds result;
+    if (!Intersects(other)) return result;
+    result.min = Vector2(std::max(min.x, other.min.x), std::max(min.y, other.min.y));
+    result.max = Vector2(std::min(max.x, other.max.x), std::min(max.y, other.max.y));
+    return result;
+}
+
+bool Bounds::Contains(Vector2 point) const {
+    return point.x >= min.x && point.x <= max.x && point.y >= min.y && point.y <= max.y;
+}
+
+bool Bounds::Contains(const Bounds& other) const {
+    if (IsEmpty() || other.IsEmpty()) return false;
+    return other.min.x >= min.x && other.max.x <= max.x && other.min.y >= min.y && other.max.y <= max.y;
+}
+
+bool Bounds::Intersects(const Bounds& other) const {
+    if (IsEmpty() || other.IsEmpty()) return false;
+    return other.min.x <= max.x && other.max.x >= min.x && other.min.y <= max.y && other.max.y >= min.y;
+}
+
+} // namespace Core
@@ -0,0 +1,314 @@
+#include <core/math/Geometry.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Core {
+
+namespace {
+// Slack on segment parameters, so that a segment ending exactly on another one is not lost to rounding
+constexpr double PARAMETER_SLACK = 1e-9;
+
+bool OnSegment(double t) { return t >= -PARAMETER_SLACK && t <= 1 + PARAMETER_SLACK; }
+} // namespace
+
+Intersections IntersectSegments(Vector2 a0, Vector2 a1, Vector2 b0, Vector2 b1) {
+    Intersections result;
+    double rx = double(a1.x) - a0.x, ry = double(a1.y) - a0.y;
+    double sx = double(b1.x) - b0.x, sy = double(b1.y) - b0.y;
+    double qx = double(b0.x) - a0.x, qy = double(b0.y) - a0.y;
+
+    double denominator = rx * sy - ry * sx;
+    if (denominator == 0) return result;
+    double t = (qx * sy - qy * sx) / denominator;
+    double u = (qx * ry - qy * rx) / denominator;
+    if (!OnSegment(t) || !OnSegment(u)) return result;
+
+    t = std::clamp(t, 0.0, 1.0);
+    result.Add(Vector2(float(a0.x + rx * t), float(a0.y + ry * t)));
+    return result;
+}
+
+Intersections IntersectSegmentCircle(Vector2 a0, Vector2 a1, Vector2 center, float radius) {
+    Intersections result;
+    double dx = double(a1.x) - a0.x, dy = double(a1.y) - a0.y;
+    double fx = double(a0.x) - center.x, fy = double(a0.y) - center.y;
+
+    // |a0 + t d - center|^2 = r^2
+    double a = dx * dx + dy * dy;
+    if (a == 0) return result;
+    double b = 2 * (fx * dx + fy * dy);
+    double c = fx * fx + fy * fy - double(radius) * radius;
+    double discriminant = b * b - 4 * a * c;
+    if (discriminant < 0) return result;
+
+    double root = std::sqrt(discriminant);
+    double roots[2] = {(-b - root) / (2 * a), (-b + root) / (2 * a)};
+    for (int i = 0; i < (discriminant == 0 ? 1 : 2); i++) {
+        if (!OnSegment(roots[i])) continue;
+        double t = std::clamp(roots[i], 0.0, 1.0);
+        result.Add(Vector2(float(a0.x + dx * t), float(a0.y + dy * t)));
+    }
+    return result;
+}
+
+Intersections IntersectCircles(Vector2 center0, float radius0, Vector2 center1, float radius1) {
+    Intersections result;
+    double dx = double(center1.x) - center0.x, dy = double(center1.y) - center0.y;
+    double distance = std::sqrt(dx * dx + dy * dy);
+    if (distance == 0) return result;
+    double r0 = radius0, r1 = radius1;
+    if (distance > r0 + r1 || distance < std::abs(r0 - r1)) return result;
+
+    // Distance from center0 to the chord through both points, and half the chord
+    double along = (r0 * r0 - r1 * r1 + distance * distance) / (2 * distance);
+    double half_chord = std::sqrt(std::max(0.0, r0 * r0 - along * along));
+    double mx = center0.x + dx * along / distance, my = center0.y + dy * along / distance;
+    double ox = -dy * half_chord / distance, oy = dx * half_chord / distance;
+
+    result.Add(Vector2(float(mx + ox), float(my + oy)));
+    if (half_chord > 0) result.Add(Vector2(float(mx - ox), float(my - oy)));
+    return result;
+}
+
+Intersections IntersectLineSegment(Vector2 origin, Vector2 direction, Vector2 a0, Vector2 a1) {
+    Intersections result;
+    double rx = direction.x, ry = direction.y;
+    double sx = double(a1.x) - a0.x, sy = double(a1.y) - a0.y;
+    double qx = double(a0.x) - origin.x, qy = double(a0.y) - origin.y;
+
+    double denominator = rx * sy - ry * sx;
+    if (denominator == 0) return result;
+    double u = (qx * ry - qy * rx) / denominator;
+    if (!OnSegment(u)) return result;
+
+    u = std::clamp(u, 0.0, 1.0);
+    result.Add(Vector2(float(a0.x + sx * u), float(a0.y + sy * u)));
+    return result;
+}
+
+Intersections IntersectLineCircle(Vector2 origin, Vector2 direction, Vector2 center, float radius) {
+    Intersections result;
+    double dx = direction.x, dy = direction.y;
+    double fx = double(origin.x) - center.x, fy = double(origin.y) - center.y;
+
+    // |origin + t d - center|^2 = r^2 for any t
+    double a = dx * dx + dy * dy;
+    if (a == 0) return result;
+    double b = 2 * (fx * dx + fy * dy);
+    double c = fx * fx + fy * fy - double(radius) * radius;
+    double discriminant = b * b - 4 * a * c;
+    if (discriminant < 0) return result;
+
+    double root = std::sqrt(discriminant);
+    result.Add(Vector2(float(origin.x + dx * (-b - root) / (2 * a)), float(origin.y + dy * (-b - root) / (2 * a))));
+    if (discriminant > 0) {
+        result.Add(Vector2(float(origin.x + dx * (-b + root) / (2 * a)), float(origin.y + dy * (-b + root) / (2 * a))));
+    }
+    return result;
+}
+
+Intersections IntersectLines(Vector2 origin0, Vector2 direction0, Vector2 origin1, Vector2 direction1) {
+    Intersections result;
+    double rx = direction0.x, ry = direction0.y;
+    double sx = direction1.x, sy = direction1.y;
+    double qx = double(origin1.x) - origin0.x, qy = double(origin1.y) - origin0.y;
+
+    double denominator = rx * sy - ry * sx;
+    if (denominator == 0) return result;
+    double t = (qx * sy - qy * sx) / denominator;
+    result.Add(Vector2(float(origin0.x + rx * t), float(origin0.y + ry * t)));
+    return result;
+}
+
+float DistanceToSegment(Vector2 point, Vector2 a, Vector2 b) {
+    double dx = double(b.x) - a.x, dy = double(b.y) - a.y;
+    double px = double(point.x) - a.x, py = double(point.y) - a.y;
+    double length_squared = dx * dx + dy * dy;
+    double t = length_squared == 0 ? 0 : std::clamp((px * dx + py * dy) / length_squared, 0.0, 1.0);
+    return float(std::hypot(px - dx * t, py - dy * t));
+}
+
+bool ClipLine(Vector2 origin, Vector2 direction, const Bounds& box, double& t0, double& t1) {
+    if (box.IsEmpty()) return false;
+    // Liang-Barsky, one pair of slabs per axis
+    double p[4] = {-double(direction.x), direction.x, -double(direction.y), direction.y};
+    double q[4] = {double(origin.x) - box.min.x, double(box.max.x) - origin.x, double(origin.y) - box.min.y,
+        double(box.max.y) - origin.y};
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0) {
+            if (q[i] < 0) return false;
+            continue;
+        }
+        double r = q[i] / p[i];
+        if (p[i] < 0) {
+            t0 = std::max(t0, r);
+        } else {
+            t1 = std::min(t1, r);
+        }
+        if (t0 > t1) return false;
+    }
+    return true;
+}
+
+namespace {
+// Flip the parity of the points whose ray to the right crosses the edge from a to b. Branch free, so it vectorizes
+// at -O3.
+void CrossEdge(const float* px, const float* py, uint32_t* parity, size_t count, Vector2 a, Vector2 b) {
+    float ax = a.x, ay = a.y, by = b.y;
+    float slope = (b.x - ax) / (by - ay);
+    for (size_t k = 0; k < count; k++) {
+        float y = py[k];
+        uint32_t spans = uint32_t(ay > y) ^ uint32_t(by > y);
+        uint32_t left = uint32_t(px[k] < ax + (y - ay) * slope);
+        parity[k] ^= spans & left;
+    }
+}
+} // namespace
+
+void PointsInPolygon(const PointBatch& points, const std::vector<Vector2>& polygon, std::vector<uint32_t>& inside) {
+    size_t count = points.Size();
+    inside.assign(count, 0);
+    if (polygon.size() < 3 || count == 0) return;
+
+    float low = polygon[0].y, high = polygon[0].y;
+    for (const Vector2& vertex : polygon) {
+        low = std::min(low, vertex.y);
+        high = std::max(high, vertex.y);
+    }
+    if (!(low < high)) return;
+
+    // Cut the polygon's height into bands and sort the points into them, so that an edge is only tested against the
+    // points in the bands it spans instead of all of them. Points above or below the polygon are outside.
+    size_t bands = polygon.size();
+    float scale = float(bands) / (high - low);
+    auto band_of = [&](float y) { return std::min(size_t((y - low) * scale), bands - 1); };
+
+    std::vector<uint32_t> starts(bands + 1, 0);
+    for (size_t k = 0; k < count; k++) {
+        float y = points.y[k];
+        if (y >= low && y <= high) starts[band_of(y) + 1]++;
+    }
+    for (size_t band = 0; band < bands; band++) {
+        starts[band + 1] += starts[band];
+    }
+
+    size_t banded = starts[bands];
+    std::vector<float> xs(banded), ys(banded);
+    std::vector<uint32_t> order(banded), parity(banded, 0);
+    std::vector<uint32_t> next(starts.begin(), starts.end() - 1);
+    for (size_t k = 0; k < count; k++) {
+        float y = points.y[k];
+        if (!(y >= low && y <= high)) continue;
+        uint32_t slot = next[band_of(y)]++;
+        xs[slot] = points.x[k];
+        ys[slot] = y;
+        order[slot] = uint32_t(k);
+    }
+
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        const Vector2& a = polygon[j];
+        const Vector2& b = polygon[i];
+        // Horizontal edges never cross the ray to the right of a point
+        if (a.y == b.y) continue;
+        size_t first = starts[band_of(std::min(a.y, b.y))];
+        size_t last = starts[band_of(std::max(a.y, b.y)) + 1];
+        CrossEdge(xs.data() + first, ys.data() + first, parity.data() + first, last - first, a, b);
+    }
+
+    for (size_t slot = 0; slot < banded; slot++) {
+        inside[order[slot]] = parity[slot];
+    }
+}
+
+namespace {
+struct ScanEdge {
+    // Lines the edge is active for, [begin, end)
+    int begin, end;
+    // x where the edge's lower end is, how far x moves per unit of y, and the y it starts from
+    double x, slope, y;
+    // +1 for an edge running up, -1 running down
+    int winding;
+    // x on the current line
+    double at;
+};
+} // namespace
+
+void ScanPolygon(const std::vector<std::vector<Vector2>>& contours, FillRule rule, float first, float step, int count,
+    const std::function<void(float y, float x0, float x1)>& span) {
+    if (count <= 0 || !(step > 0)) return;
+
+    std::vector<ScanEdge> edges;
+    for (auto& contour : contours) {
+        for (size_t i = 0, j = contour.size() - 1; i < contour.size(); j = i++) {
+            Vector2 a = contour[j], b = contour[i];
+            // Horizontal edges are never crossed by a horizontal line
+            if (a.y == b.y) continue;
+            int winding = a.y < b.y ? 1 : -1;
+            if (b.y < a.y) std::swap(a, b);
+            double begin = std::ceil((double(a.y) - first) / step);
+            double end = std::ceil((double(b.y) - first) / step);
+            if (end <= 0 || begin >= count) continue;
+            ScanEdge edge;
+            edge.begin = int(std::max(begin, 0.0));
+            edge.end = int(std::min(end, double(count)));
+            if (edge.begin >= edge.end) continue;
+            edge.x = a.x;
+            edge.slope = (double(b.x) - a.x) / (double(b.y) - a.y);
+            edge.y = a.y;
+            edge.winding = winding;
+            edges.push_back(edge);
+        }
+    }
+    if (edges.empty()) return;
+    std::sort(edges.begin(), edges.end(), [](const ScanEdge& l, const ScanEdge& r) { return l.begin < r.begin; });
+
+    std::vector<ScanEdge*> active;
+    size_t next = 0;
+    for (int k = edges.front().begin; k < count && (next < edges.size() || !active.empty()); k++) {
+        // Skip ahead over lines no edge crosses
+        if (active.empty() && edges[next].begin > k) k = edges[next].begin;
+        while (next < edges.size() && edges[next].begin == k) {
+            active.push_back(&edges[next++]);
+        }
+        active.erase(std::remove_if(active.begin(), active.end(), [k](ScanEdge* edge) { return edge->end <= k; }),
+            active.end());
+
+        // x is worked out from the edge's end rather than stepped, so it doesn't drift over long edges. The order
+        // barely changes from one line to the next, which insertion sort handles in about one pass.
+        double y = double(first) + double(k) * step;
+        for (ScanEdge* edge : active) {
+            edge->at = edge->x + (y - edge->y) * edge->slope;
+        }
+        for (size_t i = 1; i < active.size(); i++) {
+            ScanEdge* edge = active[i];
+            size_t j = i;
+            for (; j > 0 && active[j - 1]->at > edge->at; j--) {
+                active[j] = active[j - 1];
+            }
+            active[j] = edge;
+        }
+
+        int winding = 0;
+        for (size_t i = 0; i + 1 < active.size(); i++) {
+            winding += rule == FillRule::EvenOdd ? 1 : active[i]->winding;
+            bool inside = rule == FillRule::EvenOdd ? (winding & 1) != 0 : winding != 0;
+            if (!inside || !(active[i + 1]->at > active[i]->at)) continue;
+            span(float(y), float(active[i]->at), float(active[i + 1]->at));
+        }
+    }
+}
+
+void TransformPoints(const Matrix3& matrix, PointBatch& points) {
+    const float* m = matrix.data;
+    float a = m[0], b = m[1], c = m[2], d = m[3], e = m[4], f = m[5];
+    float* xs = points.x.data();
+    float* ys = points.y.data();
+    for (size_t k = 0; k < points.Size(); k++) {
+        float x = xs[k], y = ys[k];
+        xs[k] = a * x + b * y + c;
+        ys[k] = d * x + e * y + f;
+    }
+}
+
+} // namespace Core
@@ -73,4 +73,49 @@ Matrix3 Matrix3::Scale(float x, float y) {
     return result;
 }
 
-} // namespace Core
\ No newline at end of file
+Matrix3 Matrix3::Reflection(Vector2 point, Vector2 direction) {
+    Matrix3 result;
+
+    // I - 2nn^T for the unit normal n of the line, then the offset that keeps the point in place
+    float length = direction.Length();
+    float nx = -direction.y / length;
+    float ny = direction.x / length;
+    result.data[0] = 1 - 2 * nx * nx;
+    result.data[1] = -2 * nx * ny;
+    result.data[3] = -2 * nx * ny;
+    result.data[4] = 1 - 2 * ny * ny;
+    result.data[8] = 1;
+
+    float distance = 2 * (point.x * nx + point.y * ny);
+    result.data[2] = distance * nx;
+    result.data[5] = distance * ny;
+
+    return result;
+}
+
+Matrix3 Matrix3::Rotation(Vector2 point, float angle) {
+    return Translation(point.x, point.y) * Rotation(angle) * Translation(-point.x, -point.y);
+}
+
+Matrix3 Matrix3::Scale(Vector2 point, float scale) {
+    return Translation(point.x, point.y) * Scale(scale, scale) * Translation(-point.x, -point.y);
+}
+
+float Matrix3::Determinant() const {
+    return data[0] * data[4] - data[1] * data[3];
+}
+
+Matrix3 Matrix3::Inverse() const {
+    float inverse_determinant = 1 / Determinant();
+    Matrix3 result;
+    result.data[0] = data[4] * inverse_determinant;
+    result.data[1] = -data[1] * inverse_determinant;
+    result.data[3] = -data[3] * inverse_determinant;
+    result.data[4] = data[0] * inverse_determinant;
+    result.data[2] = -(result.data[0] * data[2] + result.data[1] * data[5]);
+    result.data[5] = -(result.data[3] * data[2] + result.data[4] * data[5]);
+    result.data[8] = 1;
+    return result;
+}
+
+} // namespace Core
@@ -37,17 +37,22 @@ Transform& Transform::Rotate(float rotation) {
 }
 
 Vector2 Transform::Apply(Vector2 point) const {
-    // TODO: Add rotation
+    if (rotation != 0) point = point.Rotate(rotation);
     float x = point.x * scale + this->x;
     float y = point.y * scale + this->y;
     return Vector2(x, y);
 }
 
 Transform Transform::Inverse() const {
-    float x = -this->x / scale;
-    float y = -this->y / scale;
+    Vector2 origin = Vector2(-this->x, -this->y);
+    if (rotation != 0) origin = origin.Rotate(-rotation);
     float scale = 1 / this->scale;
-    return Transform(x, y, scale, 0);
+    return Transform(origin.x * scale, origin.y * scale, scale, -rotation);
+}
+
+Transform Transform::operator*(const Transform& inner) const {
+    Vector2 origin = Apply(Vector2(inner.x, inner.y));
+    return Transform(origin.x, origin.y, scale * inner.scale, rotation + inner.rotation);
 }
 
 } // namespace Core
\ No newline at end of file
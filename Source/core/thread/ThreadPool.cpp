@@ -0,0 +1,84 @@
+#include <core/thread/ThreadPool.h>
+
+namespace Core {
+
+ThreadPool::ThreadPool(unsigned thread_count) {
+    // The calling thread always takes a share of the work, so it counts as one of the threads
+    if (thread_count < 1) thread_count = 1;
+    for (unsigned i = 1; i < thread_count; i++) {
+        workers.emplace_back([this]() { Work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Work() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+unsigned ThreadPool::GetPartitionCount(size_t count, size_t grain) const {
+    if (grain == 0) grain = 1;
+    size_t partitions = (count + grain - 1) / grain;
+    if (partitions > GetConcurrency()) partitions = GetConcurrency();
+    if (partitions < 1) partitions = 1;
+    return partitions;
+}
+
+void ThreadPool::ParallelFor(size_t count, unsigned partitions, const RangeFunction& function) {
+    if (partitions <= 1 || workers.empty()) {
+        for (unsigned p = 0; p < partitions; p++) {
+            function(count * p / partitions, count * (p + 1) / partitions, p);
+        }
+        return;
+    }
+
+    std::mutex done_mutex;
+    std::condition_variable done;
+    unsigned remaining = partitions - 1;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (unsigned p = 1; p < partitions; p++) {
+            size_t begin = count * p / partitions;
+            size_t end = count * (p + 1) / partitions;
+            tasks.push([&, begin, end, p]() {
+                function(begin, end, p);
+                std::lock_guard<std::mutex> done_lock(done_mutex);
+                if (--remaining == 0) done.notify_one();
+            });
+        }
+    }
+    task_available.notify_all();
+
+    // Take the first range on this thread while the workers handle the rest
+    function(0, count / partitions, 0);
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done.wait(lock, [&]() { return remaining == 0; });
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+} // namespace Core
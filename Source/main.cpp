@@ -49,6 +49,42 @@ struct CadProgram : public Core::Program {
         cad.GetDispatcher()->Register(std::make_unique<Cad::PanCommand::Signature>());
         cad.GetDispatcher()->Register(std::make_unique<Cad::ZeroCommand::Signature>());
         cad.GetDispatcher()->Register(std::make_unique<Cad::CreateCircle::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::LayerCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::LayerCommand::AttributeSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::LayersCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::BlockCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::InsertCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::InsertCommand::TransformSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::TransformCommand::MoveSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::TransformCommand::RotateSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::TransformCommand::ScaleSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::TransformCommand::MirrorSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::ArrayCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::ArrayCommand::InstancedSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::ArrayCommand::PolarSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::ArrayCommand::InstancedPolarSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::TrimCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::TrimCommand::FenceSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::ExtendCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::ExtendCommand::PointSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::OffsetCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::UndoCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::UndoCommand::StepsSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::UndoCommand::RedoSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::UndoCommand::RedoStepsSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::UndoBudgetCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::ChainCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::JoinCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::OpenEndsCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::HatchCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::HatchCommand::PatternSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::HatchCommand::RuleSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::DedupeCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::DedupeCommand::DeleteSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::MeasureCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::MeasureCommand::AllSignature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::BenchCommand::Signature>());
+        cad.GetDispatcher()->Register(std::make_unique<Cad::BenchCommand::IterationsSignature>());
         cad.GetDispatcher()->Register(std::make_unique<HelpCommand::Signature>(cad.GetDispatcher()));
     }
 
@@ -0,0 +1,217 @@
+#include <cad/object/IntersectionIndex.h>
+#include <core/math/Geometry.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+// Compares the sweep against testing every pair of primitives, on drawings where three or more pieces meet at one
+// point. Pairs too close to tangent, or meeting too close to an end, for float input to decide are left out.
+
+using Primitive = Cad::IntersectionIndex::Primitive;
+using Pair = std::pair<uint32_t, uint32_t>;
+
+namespace {
+
+// Margin under which a pair counts as undecided
+constexpr float MARGIN = 1e-2f;
+
+std::mt19937 random_engine;
+
+// Spelled out rather than std::uniform_real_distribution, whose output differs between standard libraries
+float Random(float min, float max)
+{
+    return min + (max - min) * float(random_engine() >> 8) / float(1 << 24);
+}
+
+Core::Vector2 RandomPoint()
+{
+    return Core::Vector2(Random(-50, 50), Random(0, 100));
+}
+
+Core::Vector2 Polar(Core::Vector2 center, float angle, float length)
+{
+    return Core::Vector2(center.x + length * std::cos(angle), center.y + length * std::sin(angle));
+}
+
+float Distance(Core::Vector2 a, Core::Vector2 b)
+{
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+Primitive Segment(Core::Vector2 a, Core::Vector2 b, Cad::ObjectId owner)
+{
+    return Primitive{Primitive::Kind::Segment, a, b, 0, owner};
+}
+
+Primitive Circle(Core::Vector2 center, float radius, Cad::ObjectId owner)
+{
+    return Primitive{Primitive::Kind::Circle, center, center, radius, owner};
+}
+
+// A segment through the point in a random direction
+Primitive SegmentThrough(Core::Vector2 point, Cad::ObjectId owner)
+{
+    float angle = Random(0, 6.28f);
+    return Segment(Polar(point, angle, -Random(5, 40)), Polar(point, angle, Random(5, 40)), owner);
+}
+
+// A circle around a random center with the point on its outline
+Primitive CircleThrough(Core::Vector2 point, Cad::ObjectId owner)
+{
+    Core::Vector2 center = RandomPoint();
+    return Circle(center, Distance(center, point), owner);
+}
+
+bool Undecided(const Primitive& a, const Primitive& b, const Core::Intersections& found)
+{
+    if (a.kind == Primitive::Kind::Segment && b.kind == Primitive::Kind::Segment) {
+        for (Core::Vector2 end : {a.a, a.b}) {
+            if (Core::DistanceToSegment(end, b.a, b.b) < MARGIN) return true;
+        }
+        for (Core::Vector2 end : {b.a, b.b}) {
+            if (Core::DistanceToSegment(end, a.a, a.b) < MARGIN) return true;
+        }
+        return false;
+    }
+    if (a.kind == Primitive::Kind::Circle && b.kind == Primitive::Kind::Circle) {
+        float distance = Distance(a.a, b.a);
+        return std::abs(distance - (a.radius + b.radius)) < MARGIN ||
+               std::abs(distance - std::abs(a.radius - b.radius)) < MARGIN;
+    }
+    const Primitive& segment = a.kind == Primitive::Kind::Segment ? a : b;
+    const Primitive& circle = a.kind == Primitive::Kind::Segment ? b : a;
+    if (std::abs(Core::DistanceToSegment(circle.a, segment.a, segment.b) - circle.radius) < MARGIN) return true;
+    for (Core::Vector2 end : {segment.a, segment.b}) {
+        if (std::abs(Distance(end, circle.a) - circle.radius) < MARGIN) return true;
+    }
+    // Both crossings close together on the circle, just short of a tangent
+    return found.count == 2 && Distance(found.points[0], found.points[1]) < MARGIN;
+}
+
+// Pairs that meet and pairs too close to call, by testing every pair
+void BruteForce(const std::vector<Primitive>& primitives, std::set<Pair>& meeting, std::set<Pair>& undecided)
+{
+    for (uint32_t i = 0; i < primitives.size(); i++) {
+        for (uint32_t j = i + 1; j < primitives.size(); j++) {
+            const Primitive& a = primitives[i];
+            const Primitive& b = primitives[j];
+            Core::Intersections found;
+            if (a.kind == Primitive::Kind::Segment && b.kind == Primitive::Kind::Segment) {
+                found = Core::IntersectSegments(a.a, a.b, b.a, b.b);
+            } else if (a.kind == Primitive::Kind::Circle && b.kind == Primitive::Kind::Circle) {
+                found = Core::IntersectCircles(a.a, a.radius, b.a, b.radius);
+            } else if (a.kind == Primitive::Kind::Segment) {
+                found = Core::IntersectSegmentCircle(a.a, a.b, b.a, b.radius);
+            } else {
+                found = Core::IntersectSegmentCircle(b.a, b.b, a.a, a.radius);
+            }
+
+            if (Undecided(a, b, found)) {
+                undecided.insert(Pair(i, j));
+            } else if (found.count > 0) {
+                meeting.insert(Pair(i, j));
+            }
+        }
+    }
+}
+
+bool Check(const char* name, int seed, const std::vector<Primitive>& primitives)
+{
+    std::set<Pair> swept, meeting, undecided;
+    for (const auto& crossing : Cad::IntersectionIndex::Sweep(primitives)) {
+        swept.insert(Pair(crossing.first, crossing.second));
+    }
+    BruteForce(primitives, meeting, undecided);
+
+    bool passed = true;
+    for (const Pair& pair : meeting) {
+        if (swept.count(pair) > 0) continue;
+        std::printf("%s %d: missed %u and %u\n", name, seed, pair.first, pair.second);
+        passed = false;
+    }
+    for (const Pair& pair : swept) {
+        if (meeting.count(pair) > 0 || undecided.count(pair) > 0) continue;
+        std::printf("%s %d: %u and %u do not meet\n", name, seed, pair.first, pair.second);
+        passed = false;
+    }
+    return passed;
+}
+
+// A few unrelated segments around the meeting point
+void AddClutter(std::vector<Primitive>& primitives, Cad::ObjectId& owner)
+{
+    for (int i = 0; i < 3; i++) {
+        primitives.push_back(Segment(RandomPoint(), RandomPoint(), owner++));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    constexpr int CASES = 300;
+    int failed = 0;
+
+    // Two segments and a circle found to recurse forever in the sweep
+    std::vector<Primitive> reported = {
+        Segment(Core::Vector2(-2.73252153f, 79.1977539f), Core::Vector2(-13.8630829f, 20.2392082f), 1),
+        Segment(Core::Vector2(-35.6422119f, 62.0587883f), Core::Vector2(19.0466099f, 37.3781776f), 2),
+        Circle(Core::Vector2(11.7021942f, 49.7328568f), 20, 3),
+    };
+    failed += !Check("reported", 0, reported);
+
+    // Two segments and a circle through their crossing
+    for (int seed = 0; seed < CASES; seed++) {
+        random_engine.seed(seed);
+        Core::Vector2 point = RandomPoint();
+        Cad::ObjectId owner = 1;
+        std::vector<Primitive> primitives;
+        primitives.push_back(SegmentThrough(point, owner++));
+        primitives.push_back(SegmentThrough(point, owner++));
+        primitives.push_back(CircleThrough(point, owner++));
+        AddClutter(primitives, owner);
+        failed += !Check("segments and circle", seed, primitives);
+    }
+
+    // A segment starting where a segment crosses a circle
+    for (int seed = 0; seed < CASES; seed++) {
+        random_engine.seed(CASES + seed);
+        Core::Vector2 center = RandomPoint();
+        float radius = Random(5, 30);
+        Core::Vector2 point = Polar(center, Random(0, 6.28f), radius);
+        Cad::ObjectId owner = 1;
+        std::vector<Primitive> primitives;
+        primitives.push_back(Circle(center, radius, owner++));
+        primitives.push_back(SegmentThrough(point, owner++));
+        primitives.push_back(Segment(point, RandomPoint(), owner++));
+        AddClutter(primitives, owner);
+        failed += !Check("segment from crossing", seed, primitives);
+    }
+
+    // Several points where two to four pieces meet
+    for (int seed = 0; seed < CASES; seed++) {
+        random_engine.seed(2 * CASES + seed);
+        Cad::ObjectId owner = 1;
+        std::vector<Primitive> primitives;
+        for (int i = 0; i < 3; i++) {
+            Core::Vector2 point = RandomPoint();
+            int count = 2 + random_engine() % 3;
+            for (int j = 0; j < count; j++) {
+                primitives.push_back(random_engine() % 3 == 0 ? CircleThrough(point, owner++)
+                                                               : SegmentThrough(point, owner++));
+            }
+        }
+        AddClutter(primitives, owner);
+        failed += !Check("concurrent points", seed, primitives);
+    }
+
+    if (failed > 0) {
+        std::printf("%d cases failed\n", failed);
+        return 1;
+    }
+    return 0;
+}